@@ -1,67 +1,373 @@
 #pragma once
+#include <cstdint>      // For uint64_t
 #include <memory>       // For std::shared_ptr
 #include <string>       // For std::string
 #include <string_view>  // For std::string_view
 #include <vector>       // For std::vector
 #include <optional>     // For std::optional
+#include <stdexcept>    // For std::runtime_error
 
 namespace rshim {
 
+struct BlockCacheArgs {
+  uint64_t    capacity = 1ull << 30;
+  std::string type = "lru";              // "lru" | "hyper_clock" (lock-free lookups)
+  int         num_shard_bits = -1;        // -1: picked from capacity
+  double      high_pri_pool_ratio = 0.3;  // reserved for index/filter blocks
+  bool        strict_capacity_limit = false;  // true: inserts fail instead of overshooting capacity
+  // LZ4-compressed in-memory tier below the cache: blocks evicted from it are kept here
+  // compressed and served without a disk read (0 = none)
+  uint64_t    secondary_capacity = 0;
+};
+
+// Block cache that several DBs can share through OpenArgs::block_cache, so one process
+// has one bounded cache with global eviction instead of one per DB.
+class BlockCache {
+public:
+  static std::shared_ptr<BlockCache> Create(const BlockCacheArgs& args = BlockCacheArgs());
+  virtual ~BlockCache() = default;
+
+  virtual const BlockCacheArgs& Args() const = 0;
+  virtual size_t Capacity() const = 0;
+  virtual void   SetCapacity(size_t bytes) = 0;
+  virtual size_t Usage() const = 0;        // bytes held, across every DB using the cache
+  virtual size_t PinnedUsage() const = 0;  // bytes held by readers and pinned index/filter blocks
+  virtual size_t SecondaryUsage() const = 0;  // compressed bytes in the secondary tier
+};
+
+struct WriteBufferManagerArgs {
+  uint64_t buffer_size = 8ull << 30;  // memtable memory of every DB using the manager, combined
+  // Charge memtable memory to this block cache as well, so the two share one budget
+  std::shared_ptr<BlockCache> cost_to_cache;
+  // true: once the budget is exceeded, writers stall until flushes bring usage back down (a
+  // hard cap). false: RocksDB only triggers flushes and usage may overshoot.
+  bool allow_stall = true;
+};
+
+// Memtable budget shared by DBs through OpenArgs::write_buffer_manager: flushes are triggered
+// (and with allow_stall, writes held) by the combined usage, not per DB.
+class WriteBufferManager {
+public:
+  static std::shared_ptr<WriteBufferManager> Create(const WriteBufferManagerArgs& args = WriteBufferManagerArgs());
+  virtual ~WriteBufferManager() = default;
+
+  virtual const WriteBufferManagerArgs& Args() const = 0;
+  virtual size_t BufferSize() const = 0;
+  virtual void   SetBufferSize(size_t bytes) = 0;
+  virtual void   SetAllowStall(bool allow) = 0;
+  virtual size_t MemoryUsage() const = 0;         // all memtables, including those being flushed
+  virtual size_t MutableMemoryUsage() const = 0;  // memtables still taking writes
+};
+
 struct OpenArgs {
   std::string path;
   bool        read_only         = false;
   bool        create_if_missing = false;
-  std::string profile = "write";
+  std::string profile = "write";  // "read" | "write" | "ingest-universal" [":packed24"], or "file:<OPTIONS file or DB dir>"
+  // Applied on top of the profile: RocksDB option string ("k=v;...") or OPTIONS-style INI text
+  std::string options_overlay;
+  // Hardware the built-in profiles size themselves for; 0 = detect (see DetectHardware)
+  unsigned cpus         = 0;
+  uint64_t memory_bytes = 0;
+  // Shared block cache; null gives the DB a private one sized by its profile,
+  // of cache_type ("" = lru, or "hyper_clock" for many concurrent readers).
+  // A file: profile keeps the file's table options: cache_type and secondary_cache_bytes
+  // are rejected with it, block_cache still replaces the file's cache.
+  std::shared_ptr<BlockCache> block_cache;
+  std::string cache_type;
+  uint64_t    secondary_cache_bytes = 0;  // compressed tier below the profile's own cache (0 = none)
+  // Shared memtable budget; null leaves each DB bounded only by its own write buffers
+  std::shared_ptr<WriteBufferManager> write_buffer_manager;
+  // Background I/O (flush and compaction reads and writes) in bytes/s; 0 = unlimited.
+  // auto_tune lets RocksDB move the rate below that ceiling by how much work is pending.
+  uint64_t    io_rate_limit = 0;
+  bool        io_rate_auto_tune = false;
+  // Ticker statistics (block cache hits/misses for CacheStats). Off by default: every
+  // counted event then costs a per-core counter update.
+  bool        statistics = false;
+};
+
+// What this process may actually use, not what the machine has.
+struct HardwareInfo {
+  unsigned cpus         = 1;  // CPU affinity mask, capped by the cgroup CPU quota
+  uint64_t memory_bytes = 0;  // physical RAM on the NUMA nodes we run on, capped by the cgroup memory limit
+  unsigned numa_nodes   = 1;  // nodes in the machine
+  unsigned numa_nodes_used = 1;  // nodes spanned by the affinity mask
+  bool     cpu_limited    = false;  // a cgroup CPU quota applies
+  bool     memory_limited = false;  // a cgroup memory limit applies
+};
+
+// Reads sched affinity, /sys NUMA topology and cgroup v1/v2 limits (cpu.max, memory.max).
+HardwareInfo DetectHardware();
+
+// Per-call read tuning. Defaults match a plain rocksdb::ReadOptions.
+struct ReadArgs {
+  bool   fill_cache     = true;   // false: blocks read by this call are not inserted into the block cache
+  size_t readahead_size = 0;      // 0 = RocksDB's auto readahead
+  bool   async_io       = false;  // prefetch upcoming blocks while the caller consumes the current one
+  bool   tailing        = false;  // iterator keeps seeing writes made after it was created
+  bool   verify_checksums = true;  // false skips block checksum verification on the hot path
+  bool   cache_only     = false;  // serve from memtables/block cache only; a disk read raises IncompleteError
+  // Time bounds in seconds (0 = none); exceeding one raises TimeoutError.
+  double deadline_sec   = 0;      // whole call, from when it starts (an iterator: from its creation)
+  double io_timeout_sec = 0;      // each file read issued by the call
+
+  // Preset for bulk/full scans: leave the block cache to point lookups and stream with big readahead.
+  static ReadArgs Scan() {
+    ReadArgs r;
+    r.fill_cache = false;
+    r.readahead_size = 2ull << 20;  // 2 MiB
+    r.async_io = true;
+    return r;
+  }
+
+  // Preset for latency-critical lookups that must fail fast rather than wait on disk.
+  static ReadArgs CacheOnly() {
+    ReadArgs r;
+    r.cache_only = true;
+    r.verify_checksums = false;
+    return r;
+  }
+
+  // Named presets: "default", "scan", "cache_only", "fast" (default without checksum checks)
+  static ReadArgs Preset(const std::string& name);
+};
+
+// Raised by reads that could not complete within their ReadArgs (e.g. cache_only and the data is on disk)
+class IncompleteError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Raised by reads that ran past ReadArgs::deadline_sec or io_timeout_sec
+class TimeoutError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Block cache figures for one DB. The cache-wide numbers include every DB sharing the cache;
+// blocks carry no owner, so a DB's share is only visible through its own traffic counters.
+struct BlockCacheStats {
+  bool     shared       = false;  // opened with OpenArgs::block_cache
+  uint64_t capacity     = 0;
+  uint64_t usage        = 0;
+  uint64_t pinned_usage = 0;
+  // This DB since open; all zero unless it was opened with OpenArgs::statistics
+  bool     statistics     = false;
+  uint64_t hits           = 0;
+  uint64_t misses         = 0;
+  uint64_t bytes_inserted = 0;  // charged to the cache on insert
+  uint64_t bytes_read     = 0;  // served from the cache
+  uint64_t secondary_hits = 0;  // of the hits, served from the compressed tier (decompressed on the way)
+};
+
+// Values found by DB::MultiGet, packed like PackedSlices: value i is data[offsets[i], offsets[i+1])
+// and is empty when found[i] is 0.
+struct MultiGetResult {
+  std::string           data;
+  std::vector<uint64_t> offsets;  // count + 1 entries
+  std::vector<uint8_t>  found;
+};
+
+// A value read in place: points into the pinned block-cache block (or memtable copy) until
+// destroyed. Must not outlive the DB it came from; DB::Close() refuses while one is alive.
+class PinnedValue {
+public:
+  virtual ~PinnedValue() = default;
+  virtual std::string_view View() const = 0;
 };
 
 class Iterator {
 public:
   virtual ~Iterator() = default;
-  virtual void Seek(const std::string& lower) = 0;
+  virtual void Seek(std::string_view lower) = 0;
   virtual bool Valid() const = 0;
   virtual std::string_view Key() const = 0;
   virtual std::string_view Value() const = 0;
   virtual void Next() = 0;
+
+  // Re-pin the iterator to the DB's latest state. Tailing iterators already follow
+  // new writes, so for them this only resets the WaitForNew() watermark.
+  virtual void Refresh() = 0;
+
+  // Block until the DB holds writes newer than the last ones reported, or until
+  // timeout_sec elapses (< 0 waits forever). Returns true if new data arrived;
+  // re-Seek (tailing) or Refresh() + Seek (snapshot) to read it.
+  virtual bool WaitForNew(double timeout_sec) = 0;
+};
+
+// Packed byte strings in one flat buffer: element i is data[offsets[i], offsets[i+1]),
+// so offsets holds count + 1 entries. Borrowed; the caller keeps both buffers alive.
+struct PackedSlices {
+  const char*     data    = nullptr;
+  const uint64_t* offsets = nullptr;
+  size_t          count   = 0;
+
+  std::string_view operator[](size_t i) const {
+    return {data + offsets[i], static_cast<size_t>(offsets[i + 1] - offsets[i])};
+  }
 };
 
 class WriteBatch {
 public:
   virtual ~WriteBatch() = default;
-  virtual void Put(const std::string& k, const std::string& v) = 0;
-  virtual void Delete(const std::string& k) = 0;
-  virtual void Merge(const std::string& k, const std::string& v) = 0;
+  // Keys and values are borrowed for the duration of the call only
+  virtual void Put(std::string_view k, std::string_view v) = 0;
+  virtual void Delete(std::string_view k) = 0;
+  virtual void Merge(std::string_view k, std::string_view v) = 0;
+  virtual void DeleteRange(std::string_view begin, std::string_view end) = 0;  // [begin, end)
 
   // Batch operations for reduced Python→C++ overhead
-  virtual void PutBatch(const std::vector<std::pair<std::string, std::string>>& items) = 0;
-  virtual void MergeBatch(const std::vector<std::pair<std::string, std::string>>& items) = 0;
+  virtual void PutBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) = 0;
+  virtual void MergeBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) = 0;
+
+  // Zero-copy bulk append from flat buffers; keys.count must equal values.count
+  virtual void PutBuffers(const PackedSlices& keys, const PackedSlices& values) = 0;
+  virtual void MergeBuffers(const PackedSlices& keys, const PackedSlices& values) = 0;
 
   virtual void Commit() = 0;
   virtual void Discard() {}
 };
 
+// WriteBatch that commits itself once it holds max_bytes or max_ops. A full buffer
+// is handed to a background committer and appends continue into a second buffer;
+// appends block only while both buffers are busy. Commit() hands off what is left
+// and waits for it. A failed background write is raised by the next hand-off or Commit().
+// DB::Close() commits what was appended and stops the committer; later commits raise.
+// Appends may come from several threads. Destroying the batch commits what is left, but a
+// failure of that last write is lost: call Commit() to see it.
+class AutoWriteBatch : public WriteBatch {
+public:
+  virtual void Flush() = 0;  // hand off the current buffer without waiting for it to land
+  // An append of about `bytes` would have to wait for the committer (both buffers busy)
+  virtual bool WouldBlock(size_t bytes) = 0;
+  virtual uint64_t CommittedOps() const = 0;
+  virtual uint64_t CommittedBytes() const = 0;
+};
+
+// WriteBatch backed by rocksdb::WriteBatchWithIndex: pending writes can be read back
+// before Commit(), on their own or layered over the DB. Keys are indexed with the
+// latest write winning. DeleteRange is unsupported and throws.
+class IndexedWriteBatch : public WriteBatch {
+public:
+  // Throws if the batch holds only merge operands for k (the DB is needed to resolve them)
+  [[nodiscard]] virtual bool GetFromBatch(std::string_view k, std::string* out) = 0;
+  [[nodiscard]] virtual bool GetFromBatchAndDB(std::string_view k, std::string* out,
+                                               const ReadArgs& ra = ReadArgs()) = 0;
+
+  // Iterator over the DB with this batch's pending writes applied on top
+  virtual std::shared_ptr<Iterator> NewIterator(const ReadArgs& ra = ReadArgs()) = 0;
+};
+
+struct WriterPoolStats {
+  uint64_t batches = 0;      // batches written successfully
+  uint64_t ops = 0;          // records in those batches
+  uint64_t bytes = 0;        // batch payload bytes written
+  uint64_t errors = 0;       // batches that failed
+  uint64_t pending = 0;      // submitted but not yet written
+  double   elapsed_sec = 0;  // since the pool was created
+};
+
+// N C++ committer threads writing into one DB. Submissions go round-robin into
+// per-thread lock-free MPSC queues and every thread calls DB::Write on its own,
+// so memtable inserts run concurrently. Batches carry no ordering between each other.
+class WriterPool {
+public:
+  virtual ~WriterPool() = default;
+
+  // Takes the batch's pending writes (the batch is left empty and reusable)
+  virtual void Submit(WriteBatch& batch) = 0;
+  virtual void SubmitBuffers(const PackedSlices& keys, const PackedSlices& values, bool merge) = 0;
+
+  // Block until everything submitted so far has been written; raises the first failure since the last Wait()
+  virtual void Wait() = 0;
+  virtual WriterPoolStats Stats() const = 0;
+  // Refuse new submissions, write everything already accepted, stop the threads, then
+  // raise any failure like Wait(). DB::Close() does the same minus the raise for live pools.
+  virtual void Close() = 0;
+};
+
 class DB {
 public:
   static std::shared_ptr<DB> Open(const OpenArgs& args);
   virtual ~DB() = default;
 
+  // Throws while a PinnedValue of this DB is alive
   virtual void Close() = 0;
 
-  [[nodiscard]] virtual bool Get(const std::string& k, std::string* out) = 0;
-  virtual void Put(const std::string& k, const std::string& v) = 0;
-  virtual void Delete(const std::string& k) = 0;
-  virtual void Merge(const std::string& k, const std::string& v) = 0;
+  // Keys and values are borrowed for the duration of the call only
+  [[nodiscard]] virtual bool Get(std::string_view k, std::string* out, const ReadArgs& ra = ReadArgs()) = 0;
+  // Zero-copy lookup; nullptr when the key is absent
+  virtual std::shared_ptr<PinnedValue> GetPinned(std::string_view k, const ReadArgs& ra = ReadArgs()) = 0;
+  // Copy the value into buf if it fits. Returns the value's size (nothing is copied
+  // when it exceeds cap), or nullopt when the key is absent.
+  virtual std::optional<size_t> GetInto(std::string_view k, char* buf, size_t cap,
+                                        const ReadArgs& ra = ReadArgs()) = 0;
+  virtual void Put(std::string_view k, std::string_view v) = 0;
+  virtual void Delete(std::string_view k) = 0;
+  virtual void Merge(std::string_view k, std::string_view v) = 0;
+
+  // Batched point lookups through rocksdb::DB::MultiGet. Unsorted keys are looked up in
+  // key order; results always come back in input order.
+  virtual MultiGetResult MultiGet(const std::vector<std::string_view>& keys, const ReadArgs& ra = ReadArgs()) = 0;
+  virtual MultiGetResult MultiGetBuffers(const PackedSlices& keys, const ReadArgs& ra = ReadArgs()) = 0;
+
+  // Memory-only existence check through KeyMayExist (bloom filters, memtables, cached blocks;
+  // no disk reads). 0 means the key is definitely absent, 1 that it may exist. If values is
+  // non-null it receives the values that could be answered from memory, packed like MultiGet.
+  // ra applies as for Get, except that the lookup stays in memory whatever its read tier.
+  virtual std::vector<uint8_t> MayExist(const std::vector<std::string_view>& keys,
+                                        MultiGetResult* values = nullptr, const ReadArgs& ra = ReadArgs()) = 0;
+  virtual std::vector<uint8_t> MayExistBuffers(const PackedSlices& keys, MultiGetResult* values = nullptr,
+                                               const ReadArgs& ra = ReadArgs()) = 0;
+
+  // Remove [begin, end) with a single range tombstone. drop_files first deletes the SST
+  // files lying entirely inside the range, so most of the data never has to be compacted away.
+  // Those files vanish without a tombstone, under open snapshots and iterators too: opt in
+  // only when no reader may still need the range.
+  virtual void DeleteRange(std::string_view begin, std::string_view end, bool drop_files = false) = 0;
+  // Remove every key that starts with prefix (an empty prefix clears the DB). A prefix with
+  // no successor (empty or all 0xFF) has no end key: the range ends at the last key present
+  // when the call runs, so a key written past it concurrently survives.
+  virtual void DeletePrefix(std::string_view prefix, bool drop_files = false) = 0;
+
+  virtual std::shared_ptr<Iterator>   NewIterator(const ReadArgs& ra = ReadArgs()) = 0;
+
+  // Allow callers to control WAL/sync per batch. sort_keys rewrites the batch at commit
+  // in key order with one record per key (last Put/Delete wins, merges are combined
+  // through the merge operator). With disable_wal, a Commit() of at least ingest_threshold
+  // bytes is written as sorted SST files and ingested instead (0 disables this).
+  virtual std::shared_ptr<WriteBatch> NewWriteBatch(bool disable_wal = false, bool sync = false,
+                                                    bool sort_keys = false, size_t ingest_threshold = 0) = 0;
+
+  // Batch whose pending writes are readable before Commit()
+  virtual std::shared_ptr<IndexedWriteBatch> NewIndexedWriteBatch(bool disable_wal = false, bool sync = false) = 0;
 
-  virtual std::shared_ptr<Iterator>   NewIterator() = 0;
+  // Size-bounded batch with background double-buffered commits (max_ops = 0: no op limit)
+  virtual std::shared_ptr<AutoWriteBatch> NewAutoWriteBatch(size_t max_bytes = 64ull << 20, size_t max_ops = 0,
+                                                            bool disable_wal = false, bool sync = false) = 0;
 
-  // Allow callers to control WAL/sync per batch
-  virtual std::shared_ptr<WriteBatch> NewWriteBatch(bool disable_wal = false, bool sync = false) = 0;
+  // threads = 0 picks one per CPU; max_pending = 0 leaves the queues unbounded
+  virtual std::shared_ptr<WriterPool> NewWriterPool(size_t threads = 0, size_t max_pending = 0,
+                                                    bool disable_wal = false, bool sync = false) = 0;
 
   virtual void FinalizeBulk() {}
+  // Turn a bulk-loaded DB into a serving one in a single rewrite: flush, reopen in place with
+  // the read profile's tables (bloom filters, partitioned index, compression) and auto-compaction
+  // off, fully compact with subcompactions, then re-enable auto-compaction. Throws while any
+  // iterator, batch, pool or pinned value of this DB is alive. If the reopen fails the DB is
+  // reopened with its previous options and the error rethrown; if that fails too, the handle
+  // is closed and every later call throws.
+  virtual void FinalizeForRead() {}
   virtual void CompactAll() {}
   virtual void CompactRange(const std::optional<std::string>& start,
                            const std::optional<std::string>& end,
                            bool exclusive = true) {}  // Added exclusive parameter with default true
   virtual std::optional<std::string> GetProperty(const std::string&) { return std::nullopt; }
+  virtual BlockCacheStats CacheStats() { return {}; }
+  // Change OpenArgs::io_rate_limit at runtime (0 = unlimited); foreground reads are never limited
+  virtual void SetIoRateLimit(uint64_t /*bytes_per_sec*/) {}
+  virtual uint64_t IoRateLimit() { return 0; }
   virtual void IngestExternalFiles(const std::vector<std::string>&, bool /*move*/, bool /*write_global_seqno*/) {}
 };
 
@@ -71,7 +377,7 @@ public:
   virtual ~SstFileWriter() = default;
 
   virtual void Open(const std::string& file_path) = 0;
-  virtual void Put(const std::string& key, const std::string& value) = 0;
+  virtual void Put(std::string_view key, std::string_view value) = 0;
   virtual void Finish() = 0;
   virtual uint64_t FileSize() = 0;
 };
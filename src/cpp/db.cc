@@ -3,20 +3,44 @@
 #include <rocks_shim/packed24_merge.hpp>
 
 #include <rocksdb/cache.h>
+#include <rocksdb/convenience.h>
 #include <rocksdb/db.h>
 #include <rocksdb/env.h>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/merge_operator.h>
 #include <rocksdb/options.h>
+#include <rocksdb/rate_limiter.h>
+#include <rocksdb/secondary_cache.h>
 #include <rocksdb/table.h>
 #include <rocksdb/utilities/options_util.h>
+#include <rocksdb/utilities/write_batch_with_index.h>
+#include <rocksdb/write_buffer_manager.h>
 #include <rocksdb/sst_file_writer.h>
-
+#include <rocksdb/statistics.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sched.h>
+#include <unistd.h>
+
 namespace rshim {
 
 namespace {
@@ -31,13 +55,95 @@ static inline std::string base_profile(const std::string& prof) {
   return pos == std::string::npos ? prof : prof.substr(0, pos);
 }
 
+static inline rocksdb::Slice to_slice(std::string_view sv) {
+  return rocksdb::Slice(sv.data(), sv.size());
+}
+
+// Smallest key above every key that starts with prefix; nullopt when none exists
+// (empty or all-0xff prefix), i.e. the range runs to the end of the keyspace.
+static inline std::optional<std::string> prefix_successor(std::string_view prefix) {
+  std::string s(prefix);
+  while (!s.empty()) {
+    auto& c = reinterpret_cast<unsigned char&>(s.back());
+    if (c != 0xff) {
+      ++c;
+      return s;
+    }
+    s.pop_back();
+  }
+  return std::nullopt;
+}
+
+static inline void check_same_count(const PackedSlices& keys, const PackedSlices& values) {
+  if (keys.count != values.count) {
+    throw std::invalid_argument("keys and values hold " + std::to_string(keys.count) + " and " +
+                                std::to_string(values.count) + " items");
+  }
+}
+
+// --- ReadArgs -> rocksdb::ReadOptions ---
+static inline rocksdb::ReadOptions to_read_options(const ReadArgs& ra) {
+  rocksdb::ReadOptions ro;
+  ro.fill_cache = ra.fill_cache;
+  ro.readahead_size = ra.readahead_size;
+  ro.async_io = ra.async_io;
+  ro.tailing = ra.tailing;
+  ro.verify_checksums = ra.verify_checksums;
+  if (ra.cache_only) ro.read_tier = rocksdb::kBlockCacheTier;
+  auto usec = [](double sec) { return std::chrono::microseconds(static_cast<int64_t>(sec * 1e6)); };
+  if (ra.deadline_sec > 0) {
+    // RocksDB wants an absolute time on the Env clock
+    ro.deadline = std::chrono::microseconds(rocksdb::Env::Default()->NowMicros()) + usec(ra.deadline_sec);
+  }
+  if (ra.io_timeout_sec > 0) ro.io_timeout = usec(ra.io_timeout_sec);
+  return ro;
+}
+
+// Read-path status -> exception; Incomplete (cache_only miss) and TimedOut get their own types
+[[noreturn]] static void throw_read_status(const rocksdb::Status& st) {
+  if (st.IsIncomplete()) throw IncompleteError(st.ToString());
+  if (st.IsTimedOut()) throw TimeoutError(st.ToString());
+  throw std::runtime_error(st.ToString());
+}
+
+// ---------------- Write notification ----------------
+// Wakes WaitForNew() callers when a write through this DB handle lands.
+// Writers only touch the mutex when someone is actually waiting.
+struct WriteSignal {
+  std::mutex mu;
+  std::condition_variable cv;
+  uint64_t epoch = 0;
+  std::atomic<int> waiters{0};
+
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) == 0) return;
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      ++epoch;
+    }
+    cv.notify_all();
+  }
+};
+
 // ---------------- Iterator ----------------
 struct ItImpl : public Iterator {
   std::unique_ptr<rocksdb::Iterator> it;
-
-  explicit ItImpl(std::unique_ptr<rocksdb::Iterator> x) : it(std::move(x)) {}
-
-  void Seek(const std::string& lower) override { it->Seek(lower); }
+  rocksdb::DB* db = nullptr;
+  std::shared_ptr<WriteSignal> signal;
+  rocksdb::SequenceNumber seen = 0;   // newest sequence number covered by this view
+  bool tailing = false;
+  std::shared_ptr<const void> owner;  // keeps whatever `it` reads from (e.g. an indexed batch) alive
+
+  ItImpl(std::unique_ptr<rocksdb::Iterator> x, rocksdb::DB* d,
+         std::shared_ptr<WriteSignal> sig, rocksdb::SequenceNumber seq, bool tail,
+         std::shared_ptr<const void> own = nullptr)
+      : it(std::move(x)), db(d), signal(std::move(sig)), seen(seq), tailing(tail), owner(std::move(own)) {}
+
+  void Seek(std::string_view lower) override {
+    it->Seek(to_slice(lower));
+    CheckStatus();
+  }
   bool Valid() const override { return it->Valid(); }
 
   // Return string_view to perfectly match the header
@@ -50,62 +156,1382 @@ struct ItImpl : public Iterator {
     return {v.data(), v.size()};
   }
 
-  void Next() override { it->Next(); }
+  void Next() override {
+    it->Next();
+    CheckStatus();
+  }
+
+  void Refresh() override {
+    // Take the watermark first so writes racing with Refresh() are reported by WaitForNew().
+    auto seq = db->GetLatestSequenceNumber();
+    if (!tailing) {
+      auto st = it->Refresh();
+      if (!st.ok()) throw std::runtime_error(st.ToString());
+    }
+    seen = seq;
+  }
+
+  bool WaitForNew(double timeout_sec) override {
+    using clock = std::chrono::steady_clock;
+    // Poll slice bounds the latency for writes that bypass this handle's signal.
+    constexpr auto kSlice = std::chrono::milliseconds(100);
+    const bool forever = timeout_sec < 0;
+    const auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(
+                                             std::chrono::duration<double>(forever ? 0.0 : timeout_sec));
+
+    signal->waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    struct Leave { std::atomic<int>& w; ~Leave() { w.fetch_sub(1, std::memory_order_relaxed); } } leave{signal->waiters};
+
+    std::unique_lock<std::mutex> lk(signal->mu);
+    for (;;) {
+      const uint64_t epoch = signal->epoch;
+      auto latest = db->GetLatestSequenceNumber();
+      if (latest > seen) {
+        seen = latest;
+        return true;
+      }
+
+      auto wake = clock::now() + kSlice;
+      if (!forever) {
+        if (clock::now() >= deadline) return false;
+        wake = std::min(wake, deadline);
+      }
+      signal->cv.wait_until(lk, wake, [&] { return signal->epoch != epoch; });
+    }
+  }
+
+ private:
+  // An iterator that stops early (I/O error, cache_only miss) reports it instead of just ending
+  void CheckStatus() const {
+    if (!it->Valid() && !it->status().ok()) throw_read_status(it->status());
+  }
+};
+
+// ---------------- Pinned value ----------------
+struct PinnedImpl : public PinnedValue {
+  rocksdb::PinnableSlice value;
+  std::shared_ptr<const void> pin;  // the DB's pin token: counts live pins without a registry
+  std::string_view View() const override { return {value.data(), value.size()}; }
+};
+
+// ---------------- Sorted batch rewrite ----------------
+// One record of a rocksdb::WriteBatch; slices point into the source batch's rep.
+struct BatchRec {
+  enum Type : uint8_t { kPut, kDelete, kMerge, kRangeDelete };
+  Type type;
+  uint32_t seq;           // position in the batch, breaks ties between equal keys
+  rocksdb::Slice key;     // begin key for kRangeDelete
+  rocksdb::Slice value;   // end key for kRangeDelete
+};
+
+struct BatchCollector : public rocksdb::WriteBatch::Handler {
+  std::vector<BatchRec> recs;
+
+  void Add(BatchRec::Type t, const rocksdb::Slice& k, const rocksdb::Slice& v) {
+    recs.push_back(BatchRec{t, static_cast<uint32_t>(recs.size()), k, v});
+  }
+
+  rocksdb::Status PutCF(uint32_t, const rocksdb::Slice& k, const rocksdb::Slice& v) override {
+    Add(BatchRec::kPut, k, v);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status DeleteCF(uint32_t, const rocksdb::Slice& k) override {
+    Add(BatchRec::kDelete, k, rocksdb::Slice());
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status MergeCF(uint32_t, const rocksdb::Slice& k, const rocksdb::Slice& v) override {
+    Add(BatchRec::kMerge, k, v);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status DeleteRangeCF(uint32_t, const rocksdb::Slice& b, const rocksdb::Slice& e) override {
+    Add(BatchRec::kRangeDelete, b, e);
+    return rocksdb::Status::OK();
+  }
+  // Anything else (single deletes, wide columns, ...) is left to the default handler,
+  // which fails the iteration; callers then keep the batch as it is.
 };
 
+// std::sort over [first, last) split across threads, then merged pairwise in parallel rounds.
+template <class It, class Cmp>
+void parallel_sort(It first, It last, Cmp cmp) {
+  constexpr size_t kMinChunk = 32 * 1024;
+  const size_t n = static_cast<size_t>(last - first);
+  const size_t parts = std::min<size_t>({std::max(1u, std::thread::hardware_concurrency()),
+                                         size_t(8), n / kMinChunk});
+  if (parts < 2) {
+    std::sort(first, last, cmp);
+    return;
+  }
+
+  std::vector<size_t> bounds(parts + 1);
+  for (size_t i = 0; i <= parts; ++i) bounds[i] = n * i / parts;
+
+  std::vector<std::thread> ts;
+  for (size_t i = 0; i < parts; ++i) {
+    ts.emplace_back([=] { std::sort(first + bounds[i], first + bounds[i + 1], cmp); });
+  }
+  for (auto& t : ts) t.join();
+
+  for (size_t width = 1; width < parts; width *= 2) {
+    ts.clear();
+    for (size_t i = 0; i + width < parts; i += 2 * width) {
+      const size_t lo = bounds[i], mid = bounds[i + width], hi = bounds[std::min(i + 2 * width, parts)];
+      ts.emplace_back([=] { std::inplace_merge(first + lo, first + mid, first + hi, cmp); });
+    }
+    for (auto& t : ts) t.join();
+  }
+}
+
+// A key's records reduced to one. value may point into the fold_key scratch string.
+struct FoldedRec {
+  BatchRec::Type type;
+  rocksdb::Slice key;
+  rocksdb::Slice value;
+};
+
+// Reduce one key's records [b, e) (all the same key, in batch order) to a single record.
+// Returns false when that is not possible (no merge operator, or it declined).
+static bool fold_key(const BatchRec* b, const BatchRec* e, const rocksdb::MergeOperator* mop,
+                     std::string* scratch, FoldedRec* out) {
+  const BatchRec* base = nullptr;  // last Put/Delete
+  for (const BatchRec* r = b; r != e; ++r) {
+    if (r->type != BatchRec::kMerge) base = r;
+  }
+  const BatchRec* ops_begin = base ? base + 1 : b;
+  out->key = b->key;
+
+  if (ops_begin == e) {
+    out->type = base->type;
+    out->value = base->value;
+    return true;
+  }
+  if (e - ops_begin == 1 && base == nullptr) {
+    out->type = BatchRec::kMerge;
+    out->value = b->value;
+    return true;
+  }
+  if (mop == nullptr) return false;
+
+  std::vector<rocksdb::Slice> operands;
+  operands.reserve(static_cast<size_t>(e - ops_begin));
+  for (const BatchRec* r = ops_begin; r != e; ++r) operands.push_back(r->value);
+
+  scratch->clear();
+  if (base != nullptr) {
+    // Put/Delete followed by merges resolves to a plain Put
+    const rocksdb::Slice* existing = base->type == BatchRec::kPut ? &base->value : nullptr;
+    rocksdb::Slice existing_operand;
+    rocksdb::MergeOperator::MergeOperationInput in(out->key, existing, operands, nullptr);
+    rocksdb::MergeOperator::MergeOperationOutput res(*scratch, existing_operand);
+    if (!mop->FullMergeV2(in, &res)) return false;
+    out->type = BatchRec::kPut;
+    out->value = existing_operand.data() != nullptr ? existing_operand : rocksdb::Slice(*scratch);
+    return true;
+  }
+
+  std::deque<rocksdb::Slice> dq(operands.begin(), operands.end());
+  if (!mop->PartialMergeMulti(out->key, dq, scratch, nullptr)) return false;
+  out->type = BatchRec::kMerge;
+  out->value = *scratch;
+  return true;
+}
+
+// Emit one key's records [b, e) into out: folded into one record when possible, as they were otherwise.
+static void emit_key(const BatchRec* b, const BatchRec* e, const rocksdb::MergeOperator* mop,
+                     rocksdb::WriteBatch* out) {
+  std::string scratch;
+  FoldedRec f;
+  if (!fold_key(b, e, mop, &scratch, &f)) {
+    const BatchRec* first = b;  // the last Put/Delete and everything after it
+    for (const BatchRec* r = b; r != e; ++r) {
+      if (r->type != BatchRec::kMerge) first = r;
+    }
+    for (const BatchRec* r = first; r != e; ++r) {
+      if      (r->type == BatchRec::kPut)    out->Put(r->key, r->value);
+      else if (r->type == BatchRec::kDelete) out->Delete(r->key);
+      else                                   out->Merge(r->key, r->value);
+    }
+    return;
+  }
+  if      (f.type == BatchRec::kPut)    out->Put(f.key, f.value);
+  else if (f.type == BatchRec::kDelete) out->Delete(f.key);
+  else                                  out->Merge(f.key, f.value);
+}
+
+static bool rec_less(const BatchRec& a, const BatchRec& b) {
+  const int cmp = a.key.compare(b.key);
+  return cmp < 0 || (cmp == 0 && a.seq < b.seq);
+}
+
+// Rewrite `in` in key order with one record per key. Range deletions act as barriers:
+// the records before and after each one are folded separately, so their order still holds.
+// Returns false (leaving *out untouched) if the batch has records this does not handle.
+static bool sort_and_dedup(const rocksdb::WriteBatch& in, const rocksdb::MergeOperator* mop,
+                           rocksdb::WriteBatch* out) {
+  BatchCollector c;
+  c.recs.reserve(in.Count());
+  if (!in.Iterate(&c).ok()) return false;
+
+  rocksdb::WriteBatch sorted(in.GetDataSize());
+  auto& recs = c.recs;
+
+  size_t seg = 0;
+  for (size_t i = 0; i <= recs.size(); ++i) {
+    const bool barrier = i == recs.size() || recs[i].type == BatchRec::kRangeDelete;
+    if (!barrier) continue;
+
+    parallel_sort(recs.begin() + seg, recs.begin() + i, rec_less);
+    for (size_t j = seg; j < i;) {
+      size_t k = j + 1;
+      while (k < i && recs[k].key == recs[j].key) ++k;
+      emit_key(&recs[j], &recs[0] + k, mop, &sorted);
+      j = k;
+    }
+    if (i < recs.size()) sorted.DeleteRange(recs[i].key, recs[i].value);
+    seg = i + 1;
+  }
+
+  *out = std::move(sorted);
+  return true;
+}
+
+// ---------------- Batch -> SST ingestion ----------------
+// Writes a WAL-less batch as sorted SST files and ingests them, skipping the memtable,
+// flush and L0 compaction. Files are split at the DB's target_file_size_base and written
+// in parallel (their key ranges are disjoint).
+// Returns false, having written nothing to the DB, if the batch cannot be expressed as
+// one record per key (range deletions, merges the operator will not fold, ...).
+static bool ingest_batch(rocksdb::DB* db, const std::string& dir, const rocksdb::WriteBatch& in,
+                         const rocksdb::MergeOperator* mop) {
+  BatchCollector c;
+  c.recs.reserve(in.Count());
+  if (!in.Iterate(&c).ok()) return false;
+  auto& recs = c.recs;
+  for (const auto& r : recs) {
+    if (r.type == BatchRec::kRangeDelete) return false;
+  }
+  parallel_sort(recs.begin(), recs.end(), rec_less);
+
+  std::vector<FoldedRec> folded;
+  std::deque<std::string> merged;  // stable storage for folded merge results
+  folded.reserve(recs.size());
+  std::string scratch;
+  for (size_t j = 0; j < recs.size();) {
+    size_t k = j + 1;
+    while (k < recs.size() && recs[k].key == recs[j].key) ++k;
+    FoldedRec f;
+    if (!fold_key(&recs[j], &recs[0] + k, mop, &scratch, &f)) return false;
+    if (!scratch.empty() && f.value.data() == scratch.data()) {
+      merged.push_back(std::move(scratch));
+      f.value = merged.back();
+      scratch = std::string();
+    }
+    folded.push_back(f);
+    j = k;
+  }
+
+  const rocksdb::Options opts = db->GetOptions();
+  const uint64_t file_bytes = std::max<uint64_t>(opts.target_file_size_base, 8ull << 20);
+  std::vector<size_t> bounds{0};
+  uint64_t acc = 0;
+  for (size_t i = 0; i < folded.size(); ++i) {
+    acc += folded[i].key.size() + folded[i].value.size();
+    if (acc >= file_bytes && i + 1 < folded.size()) {
+      bounds.push_back(i + 1);
+      acc = 0;
+    }
+  }
+  bounds.push_back(folded.size());
+  const size_t nfiles = bounds.size() - 1;
+
+  static std::atomic<uint64_t> ingest_seq{0};
+  rocksdb::Env* env = db->GetEnv();
+  // A staging directory per commit, so concurrent commits never remove each other's
+  const std::string work = dir + "-" + std::to_string(env->NowMicros()) + "-" +
+                           std::to_string(ingest_seq.fetch_add(1));
+  auto st = env->CreateDirIfMissing(work);
+  if (!st.ok()) throw std::runtime_error(st.ToString());
+  std::vector<std::string> paths(nfiles);
+  for (size_t i = 0; i < nfiles; ++i) paths[i] = work + "/" + std::to_string(i) + ".sst";
+
+  const rocksdb::EnvOptions env_opts(opts);
+  std::vector<rocksdb::Status> results(nfiles);
+  std::atomic<size_t> next{0};
+  auto write_files = [&] {
+    for (size_t i; (i = next.fetch_add(1)) < nfiles;) {
+      rocksdb::SstFileWriter w(env_opts, opts, db->DefaultColumnFamily());
+      rocksdb::Status s = w.Open(paths[i]);
+      for (size_t r = bounds[i]; s.ok() && r < bounds[i + 1]; ++r) {
+        const FoldedRec& f = folded[r];
+        if      (f.type == BatchRec::kPut)    s = w.Put(f.key, f.value);
+        else if (f.type == BatchRec::kDelete) s = w.Delete(f.key);
+        else                                  s = w.Merge(f.key, f.value);
+      }
+      if (s.ok()) s = w.Finish();
+      results[i] = s;
+    }
+  };
+  const size_t nthreads = std::min<size_t>({nfiles, size_t(8), std::max(1u, std::thread::hardware_concurrency())});
+  std::vector<std::thread> ts;
+  for (size_t t = 1; t < nthreads; ++t) ts.emplace_back(write_files);
+  write_files();
+  for (auto& t : ts) t.join();
+
+  for (const auto& s : results) {
+    if (!s.ok()) { st = s; break; }
+  }
+  if (st.ok()) {
+    rocksdb::IngestExternalFileOptions io;
+    io.move_files = true;
+    st = db->IngestExternalFile(paths, io);
+  }
+  for (const auto& p : paths) env->DeleteFile(p);  // moved files are already gone
+  env->DeleteDir(work);
+  if (!st.ok()) throw std::runtime_error(st.ToString());
+  return true;
+}
+
 // ---------------- WriteBatch ----------------
 struct WbImpl : public WriteBatch {
   rocksdb::DB* db;
+  std::shared_ptr<WriteSignal> signal;
+  std::shared_ptr<rocksdb::MergeOperator> merge_op;
   rocksdb::WriteBatch batch;
   bool disable_wal = false;
   bool sync = false;
+  bool sort_keys = false;
+  size_t ingest_threshold = 0;  // 0: never ingest
+  std::string ingest_dir;
 
-  explicit WbImpl(rocksdb::DB* d, bool dis=false, bool sy=false)
-      : db(d), disable_wal(dis), sync(sy) {}
+  WbImpl(rocksdb::DB* d, std::shared_ptr<WriteSignal> sig, std::shared_ptr<rocksdb::MergeOperator> mop,
+         bool dis=false, bool sy=false, bool sorted=false, size_t ingest_at=0, std::string idir={})
+      : db(d), signal(std::move(sig)), merge_op(std::move(mop)),
+        disable_wal(dis), sync(sy), sort_keys(sorted), ingest_threshold(ingest_at), ingest_dir(std::move(idir)) {}
 
-  void Put(const std::string& k, const std::string& v) override { batch.Put(k, v); }
-  void Delete(const std::string& k) override { batch.Delete(k); }
-  void Merge(const std::string& k, const std::string& v) override { batch.Merge(k, v); }
+  void Put(std::string_view k, std::string_view v) override { batch.Put(to_slice(k), to_slice(v)); }
+  void Delete(std::string_view k) override { batch.Delete(to_slice(k)); }
+  void Merge(std::string_view k, std::string_view v) override { batch.Merge(to_slice(k), to_slice(v)); }
+  void DeleteRange(std::string_view b, std::string_view e) override { batch.DeleteRange(to_slice(b), to_slice(e)); }
 
   // Batch put: accept vector of (key, value) pairs
-  void PutBatch(const std::vector<std::pair<std::string, std::string>>& items) override {
+  void PutBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
     for (const auto& [k, v] : items) {
-      batch.Put(k, v);
+      batch.Put(to_slice(k), to_slice(v));
     }
   }
 
   // Batch merge: accept vector of (key, value) pairs
-  void MergeBatch(const std::vector<std::pair<std::string, std::string>>& items) override {
+  void MergeBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
     for (const auto& [k, v] : items) {
-      batch.Merge(k, v);
+      batch.Merge(to_slice(k), to_slice(v));
+    }
+  }
+
+  // Buffer put/merge: slices go straight from the caller's buffers into the batch rep
+  void PutBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    for (size_t i = 0; i < keys.count; ++i) {
+      batch.Put(to_slice(keys[i]), to_slice(values[i]));
+    }
+  }
+
+  void MergeBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    for (size_t i = 0; i < keys.count; ++i) {
+      batch.Merge(to_slice(keys[i]), to_slice(values[i]));
     }
   }
 
   void Commit() override {
+    // Huge WAL-less batches go to the LSM as SST files instead of through the memtable
+    if (disable_wal && ingest_threshold != 0 && batch.GetDataSize() >= ingest_threshold &&
+        ingest_batch(db, ingest_dir, batch, merge_op.get())) {
+      batch.Clear();
+      signal->Notify();
+      return;
+    }
+    Normalize();
     rocksdb::WriteOptions wo;
     wo.disableWAL = disable_wal;
     wo.sync = sync;
     auto st = db->Write(wo, &batch);
     if (!st.ok()) throw std::runtime_error(st.ToString());
     batch.Clear();
+    signal->Notify();
+  }
+
+  void Discard() override { batch.Clear(); }
+
+  // Move the pending writes out (e.g. to a WriterPool), leaving this batch empty
+  rocksdb::WriteBatch Release() {
+    Normalize();
+    rocksdb::WriteBatch out(std::move(batch));
+    batch.Clear();
+    return out;
+  }
+
+ private:
+  // sort_keys: replace the batch with its key-sorted, one-record-per-key form
+  void Normalize() {
+    if (!sort_keys || batch.Count() < 2) return;
+    rocksdb::WriteBatch sorted;
+    if (sort_and_dedup(batch, merge_op.get(), &sorted)) batch = std::move(sorted);
+  }
+};
+
+// ---------------- Indexed WriteBatch ----------------
+struct IdxWbImpl : public IndexedWriteBatch, public std::enable_shared_from_this<IdxWbImpl> {
+  rocksdb::DB* db;
+  std::shared_ptr<WriteSignal> signal;
+  rocksdb::DBOptions db_options;  // GetFromBatch needs them; fetched once
+  rocksdb::WriteBatchWithIndex batch{rocksdb::BytewiseComparator(), 0, /*overwrite_key=*/true};
+  bool disable_wal = false;
+  bool sync = false;
+
+  IdxWbImpl(rocksdb::DB* d, std::shared_ptr<WriteSignal> sig, bool dis, bool sy)
+      : db(d), signal(std::move(sig)), db_options(d->GetDBOptions()), disable_wal(dis), sync(sy) {}
+
+  void Put(std::string_view k, std::string_view v) override { batch.Put(to_slice(k), to_slice(v)); }
+  void Delete(std::string_view k) override { batch.Delete(to_slice(k)); }
+  void Merge(std::string_view k, std::string_view v) override { batch.Merge(to_slice(k), to_slice(v)); }
+  // WriteBatchWithIndex cannot index range deletions; say so rather than pass on NotSupported
+  void DeleteRange(std::string_view, std::string_view) override {
+    throw std::runtime_error("DeleteRange is unsupported on indexed batches; use a plain write batch");
+  }
+
+  void PutBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
+    for (const auto& [k, v] : items) {
+      batch.Put(to_slice(k), to_slice(v));
+    }
+  }
+
+  void MergeBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
+    for (const auto& [k, v] : items) {
+      batch.Merge(to_slice(k), to_slice(v));
+    }
+  }
+
+  void PutBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    for (size_t i = 0; i < keys.count; ++i) {
+      batch.Put(to_slice(keys[i]), to_slice(values[i]));
+    }
+  }
+
+  void MergeBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    for (size_t i = 0; i < keys.count; ++i) {
+      batch.Merge(to_slice(keys[i]), to_slice(values[i]));
+    }
+  }
+
+  [[nodiscard]] bool GetFromBatch(std::string_view k, std::string* out) override {
+    auto st = batch.GetFromBatch(db_options, to_slice(k), out);
+    if (st.IsNotFound()) return false;
+    if (st.IsMergeInProgress()) {
+      throw std::runtime_error("Key has only merge operands in this batch; use GetFromBatchAndDB");
+    }
+    if (!st.ok()) throw std::runtime_error(st.ToString());
+    return true;
+  }
+
+  [[nodiscard]] bool GetFromBatchAndDB(std::string_view k, std::string* out, const ReadArgs& ra) override {
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto st = batch.GetFromBatchAndDB(db, ro, to_slice(k), out);
+    if (st.IsNotFound()) return false;
+    if (!st.ok()) throw_read_status(st);
+    return true;
+  }
+
+  std::shared_ptr<Iterator> NewIterator(const ReadArgs& ra) override {
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto seq = db->GetLatestSequenceNumber();
+    // The batch iterator takes ownership of the base iterator
+    std::unique_ptr<rocksdb::Iterator> it(
+        batch.NewIteratorWithBase(db->DefaultColumnFamily(), db->NewIterator(ro), &ro));
+    return std::make_shared<ItImpl>(std::move(it), db, signal, seq, /*tailing=*/false, shared_from_this());
+  }
+
+  void Commit() override {
+    rocksdb::WriteOptions wo;
+    wo.disableWAL = disable_wal;
+    wo.sync = sync;
+    auto st = db->Write(wo, batch.GetWriteBatch());
+    if (!st.ok()) throw std::runtime_error(st.ToString());
+    batch.Clear();
+    signal->Notify();
   }
 
   void Discard() override { batch.Clear(); }
 };
 
+// ---------------- Auto-committing WriteBatch ----------------
+struct AutoWbImpl : public AutoWriteBatch {
+  rocksdb::DB* db;
+  std::shared_ptr<WriteSignal> signal;
+  rocksdb::WriteOptions wo;
+  size_t max_bytes;
+  size_t max_ops;
+
+  // Double buffer: appends go to `active`; `inflight` belongs to the committer while non-null.
+  rocksdb::WriteBatch bufs[2];
+  rocksdb::WriteBatch* active = &bufs[0];
+  rocksdb::WriteBatch* inflight = nullptr;
+
+  std::mutex mu;
+  std::condition_variable cv;
+  bool stop = false;
+  rocksdb::Status bg_error;
+  std::atomic<uint64_t> committed_ops{0};
+  std::atomic<uint64_t> committed_bytes{0};
+  std::thread committer;
+
+  AutoWbImpl(rocksdb::DB* d, std::shared_ptr<WriteSignal> sig,
+             size_t mb, size_t mo, bool dis, bool sy)
+      : db(d), signal(std::move(sig)), max_bytes(mb), max_ops(mo) {
+    wo.disableWAL = dis;
+    wo.sync = sy;
+    committer = std::thread([this] { Run(); });
+  }
+
+  // Commits what was appended but not yet handed off. A failure of that last write has
+  // no caller to reach and is lost; Commit() first to see it.
+  ~AutoWbImpl() override { Shutdown(); }
+
+  // The DB is closing: commit what was appended so far, then stop the committer for good.
+  // Later hand-offs throw instead of waiting on a committer that is gone.
+  void Shutdown() {
+    {
+      std::unique_lock<std::mutex> lk(mu);
+      cv.wait(lk, [this] { return inflight == nullptr; });
+      if (stop) return;
+      if (active->Count() > 0 && bg_error.ok()) {
+        inflight = active;
+        active = (active == &bufs[0]) ? &bufs[1] : &bufs[0];
+      }
+      stop = true;
+    }
+    cv.notify_all();
+    committer.join();
+  }
+
+  // Appends hold mu: producers on several threads, and Shutdown() from DB::Close(), all
+  // touch `active`. The committer only takes mu to swap buffers, so it is rarely contended.
+  void Put(std::string_view k, std::string_view v) override {
+    std::unique_lock<std::mutex> lk(mu);
+    active->Put(to_slice(k), to_slice(v));
+    MaybeHandOff(lk);
+  }
+  void Delete(std::string_view k) override {
+    std::unique_lock<std::mutex> lk(mu);
+    active->Delete(to_slice(k));
+    MaybeHandOff(lk);
+  }
+  void Merge(std::string_view k, std::string_view v) override {
+    std::unique_lock<std::mutex> lk(mu);
+    active->Merge(to_slice(k), to_slice(v));
+    MaybeHandOff(lk);
+  }
+  void DeleteRange(std::string_view b, std::string_view e) override {
+    std::unique_lock<std::mutex> lk(mu);
+    active->DeleteRange(to_slice(b), to_slice(e));
+    MaybeHandOff(lk);
+  }
+
+  void PutBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
+    std::unique_lock<std::mutex> lk(mu);
+    for (const auto& [k, v] : items) {
+      active->Put(to_slice(k), to_slice(v));
+      MaybeHandOff(lk);
+    }
+  }
+
+  void MergeBatch(const std::vector<std::pair<std::string_view, std::string_view>>& items) override {
+    std::unique_lock<std::mutex> lk(mu);
+    for (const auto& [k, v] : items) {
+      active->Merge(to_slice(k), to_slice(v));
+      MaybeHandOff(lk);
+    }
+  }
+
+  void PutBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    std::unique_lock<std::mutex> lk(mu);
+    for (size_t i = 0; i < keys.count; ++i) {
+      active->Put(to_slice(keys[i]), to_slice(values[i]));
+      MaybeHandOff(lk);
+    }
+  }
+
+  void MergeBuffers(const PackedSlices& keys, const PackedSlices& values) override {
+    check_same_count(keys, values);
+    std::unique_lock<std::mutex> lk(mu);
+    for (size_t i = 0; i < keys.count; ++i) {
+      active->Merge(to_slice(keys[i]), to_slice(values[i]));
+      MaybeHandOff(lk);
+    }
+  }
+
+  bool WouldBlock(size_t bytes) override {
+    std::lock_guard<std::mutex> lk(mu);
+    return inflight != nullptr && Due(active->GetDataSize() + bytes, active->Count() + 1);
+  }
+
+  void Flush() override {
+    std::unique_lock<std::mutex> lk(mu);
+    HandOff(lk);
+  }
+
+  void Commit() override {
+    std::unique_lock<std::mutex> lk(mu);
+    HandOff(lk);
+    cv.wait(lk, [this] { return inflight == nullptr; });
+    ThrowIfFailed();
+  }
+
+  void Discard() override {
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [this] { return inflight == nullptr; });  // a handed-off buffer cannot be recalled
+    active->Clear();
+  }
+
+  uint64_t CommittedOps() const override { return committed_ops.load(std::memory_order_relaxed); }
+  uint64_t CommittedBytes() const override { return committed_bytes.load(std::memory_order_relaxed); }
+
+ private:
+  bool Due(size_t bytes, size_t ops) const { return bytes >= max_bytes || (max_ops != 0 && ops >= max_ops); }
+
+  void MaybeHandOff(std::unique_lock<std::mutex>& lk) {
+    if (Due(active->GetDataSize(), active->Count())) HandOff(lk);
+  }
+
+  // Caller holds mu through lk
+  void HandOff(std::unique_lock<std::mutex>& lk) {
+    cv.wait(lk, [this] { return inflight == nullptr; });  // back-pressure: both buffers busy
+    ThrowIfFailed();
+    if (active->Count() == 0) return;
+    if (stop) throw std::runtime_error("AutoWriteBatch: its DB was closed");
+    inflight = active;
+    active = (active == &bufs[0]) ? &bufs[1] : &bufs[0];
+    cv.notify_all();
+  }
+
+  // Caller holds mu. Reports a background failure once, then clears it.
+  void ThrowIfFailed() {
+    if (bg_error.ok()) return;
+    auto st = bg_error;
+    bg_error = rocksdb::Status::OK();
+    throw std::runtime_error(st.ToString());
+  }
+
+  void Run() {
+    std::unique_lock<std::mutex> lk(mu);
+    for (;;) {
+      cv.wait(lk, [this] { return inflight != nullptr || stop; });
+      if (inflight == nullptr) return;  // stopping with nothing in flight
+
+      rocksdb::WriteBatch* b = inflight;
+      lk.unlock();
+      const uint64_t ops = b->Count();
+      const uint64_t bytes = b->GetDataSize();
+      auto st = db->Write(wo, b);
+      b->Clear();
+      if (st.ok()) {
+        committed_ops.fetch_add(ops, std::memory_order_relaxed);
+        committed_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        signal->Notify();
+      }
+      lk.lock();
+
+      if (!st.ok() && bg_error.ok()) bg_error = st;
+      inflight = nullptr;
+      cv.notify_all();
+    }
+  }
+};
+
+// ---------------- Writer pool ----------------
+struct PoolJob {
+  std::atomic<PoolJob*> next{nullptr};
+  rocksdb::WriteBatch batch;
+};
+
+// Vyukov intrusive MPSC queue: Push is wait-free for any number of producers,
+// Pop belongs to the one worker that owns the queue. Pop may report empty while a
+// producer is between its two stores; callers retry based on their own counter.
+class MpscQueue {
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+  void Push(PoolJob* j) {
+    j->next.store(nullptr, std::memory_order_relaxed);
+    PoolJob* prev = head_.exchange(j, std::memory_order_acq_rel);
+    prev->next.store(j, std::memory_order_release);
+  }
+
+  PoolJob* Pop() {
+    PoolJob* tail = tail_;
+    PoolJob* next = tail->next.load(std::memory_order_acquire);
+    if (tail == &stub_) {
+      if (next == nullptr) return nullptr;
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != head_.load(std::memory_order_acquire)) return nullptr;  // push in progress
+    Push(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+ private:
+  std::atomic<PoolJob*> head_;
+  PoolJob* tail_;
+  PoolJob stub_;
+};
+
+struct WriterPoolImpl : public WriterPool {
+  struct Worker {
+    MpscQueue queue;
+    std::atomic<int64_t> queued{0};  // pushed but not yet popped by this worker
+    std::mutex mu;                   // parking only
+    std::condition_variable cv;
+    std::thread thread;
+  };
+
+  rocksdb::DB* db;
+  std::shared_ptr<WriteSignal> signal;
+  rocksdb::WriteOptions wo;
+  size_t max_pending;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<size_t> next_worker{0};
+  std::atomic<bool> stopping{false};
+  std::mutex stop_mu;   // serialises Stop(): a second caller returns only once workers are joined
+  bool joined = false;  // guarded by stop_mu
+  std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+
+  // Jobs reserved, queued or running, with kClosed folded in so a producer reserves its slot and
+  // observes Close() in one compare-and-swap: after Close() sets the bit, no slot is taken and
+  // every slot taken before it is drained before the workers stop.
+  static constexpr uint64_t kClosed = uint64_t(1) << 63;
+  static constexpr uint64_t kCount = kClosed - 1;
+  std::atomic<uint64_t> pending{0};
+
+  // Totals and the first unreported error
+  std::atomic<uint64_t> batches{0}, ops{0}, bytes{0}, errors{0};
+  std::mutex err_mu;
+  rocksdb::Status first_error;
+
+  // Wait() / back-pressure; workers only take the lock when someone is waiting
+  std::mutex idle_mu;
+  std::condition_variable idle_cv;
+  std::atomic<int> idle_waiters{0};
+
+  WriterPoolImpl(rocksdb::DB* d, std::shared_ptr<WriteSignal> sig,
+                 size_t threads, size_t maxp, bool dis, bool sy)
+      : db(d), signal(std::move(sig)), max_pending(maxp) {
+    wo.disableWAL = dis;
+    wo.sync = sy;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) workers.push_back(std::make_unique<Worker>());
+    for (auto& w : workers) {
+      Worker* wp = w.get();
+      wp->thread = std::thread([this, wp] { Run(*wp); });
+    }
+  }
+
+  ~WriterPoolImpl() override {
+    try {
+      Close();
+    } catch (...) {
+      // errors were reportable through Wait(); nothing left to surface here
+    }
+  }
+
+  void Submit(WriteBatch& batch) override {
+    auto* wb = dynamic_cast<WbImpl*>(&batch);
+    if (wb == nullptr) throw std::invalid_argument("WriterPool accepts batches from NewWriteBatch() only");
+    auto job = std::make_unique<PoolJob>();
+    job->batch = wb->Release();
+    Enqueue(std::move(job));
+  }
+
+  void SubmitBuffers(const PackedSlices& keys, const PackedSlices& values, bool merge) override {
+    check_same_count(keys, values);
+    auto job = std::make_unique<PoolJob>();
+    for (size_t i = 0; i < keys.count; ++i) {
+      if (merge) job->batch.Merge(to_slice(keys[i]), to_slice(values[i]));
+      else       job->batch.Put(to_slice(keys[i]), to_slice(values[i]));
+    }
+    Enqueue(std::move(job));
+  }
+
+  void Wait() override {
+    WaitUntil([this] { return (pending.load(std::memory_order_acquire) & kCount) == 0; });
+    std::lock_guard<std::mutex> lk(err_mu);
+    if (!first_error.ok()) {
+      auto st = first_error;
+      first_error = rocksdb::Status::OK();
+      throw std::runtime_error(st.ToString());
+    }
+  }
+
+  WriterPoolStats Stats() const override {
+    WriterPoolStats st;
+    st.batches = batches.load(std::memory_order_relaxed);
+    st.ops = ops.load(std::memory_order_relaxed);
+    st.bytes = bytes.load(std::memory_order_relaxed);
+    st.errors = errors.load(std::memory_order_relaxed);
+    st.pending = pending.load(std::memory_order_relaxed) & kCount;
+    st.elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return st;
+  }
+
+  void Close() override {
+    Stop();
+    Wait();  // report anything the drained batches left behind
+  }
+
+  // Refuse new jobs, write everything already accepted, join the workers. Errors stay
+  // reportable through Wait(). Also called by DB::Close() before the DB goes away.
+  void Stop() {
+    std::lock_guard<std::mutex> stop_lk(stop_mu);
+    if (joined) return;
+    pending.fetch_or(kClosed, std::memory_order_acq_rel);
+    {
+      std::lock_guard<std::mutex> lk(idle_mu);  // producers parked on max_pending see the bit
+    }
+    idle_cv.notify_all();
+    WaitUntil([this] { return (pending.load(std::memory_order_acquire) & kCount) == 0; });
+    stopping.store(true, std::memory_order_release);
+    for (auto& w : workers) {
+      { std::lock_guard<std::mutex> lk(w->mu); }
+      w->cv.notify_one();
+    }
+    for (auto& w : workers) w->thread.join();
+    joined = true;
+  }
+
+ private:
+  template <class Pred>
+  void WaitUntil(Pred done) {
+    idle_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lk(idle_mu);
+      idle_cv.wait(lk, done);
+    }
+    idle_waiters.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void Enqueue(std::unique_ptr<PoolJob> job) {
+    // Reserve a slot: fails once closed, and never takes more than max_pending
+    uint64_t cur = pending.load(std::memory_order_acquire);
+    for (;;) {
+      if (cur & kClosed) throw std::runtime_error("WriterPool is closed");
+      if (max_pending != 0 && (cur & kCount) >= max_pending) {
+        WaitUntil([this] {
+          const uint64_t p = pending.load(std::memory_order_acquire);
+          return (p & kClosed) || (p & kCount) < max_pending;
+        });
+        cur = pending.load(std::memory_order_acquire);
+        continue;
+      }
+      if (pending.compare_exchange_weak(cur, cur + 1, std::memory_order_acq_rel, std::memory_order_acquire)) break;
+    }
+
+    Worker& w = *workers[next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size()];
+    w.queue.Push(job.release());
+    if (w.queued.fetch_add(1, std::memory_order_acq_rel) == 0) {
+      { std::lock_guard<std::mutex> lk(w.mu); }  // pairs with the worker's predicate check
+      w.cv.notify_one();
+    }
+  }
+
+  void Run(Worker& w) {
+    for (;;) {
+      PoolJob* raw = w.queue.Pop();
+      if (raw == nullptr) {
+        if (w.queued.load(std::memory_order_acquire) > 0) {
+          std::this_thread::yield();  // a producer is mid-push
+          continue;
+        }
+        std::unique_lock<std::mutex> lk(w.mu);
+        w.cv.wait(lk, [&] {
+          return w.queued.load(std::memory_order_acquire) > 0 || stopping.load(std::memory_order_acquire);
+        });
+        if (w.queued.load(std::memory_order_acquire) == 0) return;  // stopping and drained
+        continue;
+      }
+      std::unique_ptr<PoolJob> job(raw);
+      w.queued.fetch_sub(1, std::memory_order_acq_rel);
+
+      const uint64_t n = job->batch.Count();
+      const uint64_t sz = job->batch.GetDataSize();
+      auto st = db->Write(wo, &job->batch);
+      if (st.ok()) {
+        batches.fetch_add(1, std::memory_order_relaxed);
+        ops.fetch_add(n, std::memory_order_relaxed);
+        bytes.fetch_add(sz, std::memory_order_relaxed);
+        signal->Notify();
+      } else {
+        errors.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lk(err_mu);
+        if (first_error.ok()) first_error = st;
+      }
+      job.reset();
+
+      pending.fetch_sub(1, std::memory_order_acq_rel);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (idle_waiters.load(std::memory_order_relaxed) > 0) {
+        { std::lock_guard<std::mutex> lk(idle_mu); }
+        idle_cv.notify_all();
+      }
+    }
+  }
+};
+
+// ---------------- User tuning: OPTIONS files and overlays ----------------
+static void check_options_status(const rocksdb::Status& st, const std::string& what) {
+  if (!st.ok()) throw std::invalid_argument(what + ": " + st.ToString());
+}
+
+static std::string trim(std::string_view sv) {
+  const auto b = sv.find_first_not_of(" \t\r");
+  if (b == std::string_view::npos) return {};
+  const auto e = sv.find_last_not_of(" \t\r");
+  return std::string(sv.substr(b, e - b + 1));
+}
+
+// "file:<path>[:packed24]": options saved by RocksDB (an OPTIONS-xxxxxx file, or a DB
+// directory for its latest one). Custom merge operators cannot be rebuilt from the file,
+// so packed24 is restored from the suffix or from the operator name recorded in the file.
+static void load_options_file(const std::string& spec, rocksdb::Options& o) {
+  std::string path = spec;
+  bool packed24 = false;
+  const std::string kSuffix = ":packed24";
+  if (path.size() > kSuffix.size() && path.compare(path.size() - kSuffix.size(), kSuffix.size(), kSuffix) == 0) {
+    path.resize(path.size() - kSuffix.size());
+    packed24 = true;
+  }
+
+  rocksdb::ConfigOptions cfg;
+  cfg.ignore_unknown_options = false;
+  cfg.ignore_unsupported_options = true;  // e.g. our merge operator, handled below
+  rocksdb::DBOptions dbo;
+  std::vector<rocksdb::ColumnFamilyDescriptor> cfs;
+
+  bool is_dir = false;
+  rocksdb::Env* env = rocksdb::Env::Default();
+  if (env->IsDirectory(path, &is_dir).ok() && is_dir) {
+    check_options_status(rocksdb::LoadLatestOptions(cfg, path, &dbo, &cfs), "Loading options from " + path);
+    std::string name;
+    check_options_status(rocksdb::GetLatestOptionsFileName(path, env, &name), "Locating OPTIONS file in " + path);
+    path += "/" + name;
+  } else {
+    check_options_status(rocksdb::LoadOptionsFromFile(cfg, path, &dbo, &cfs), "Loading options from " + path);
+  }
+
+  auto def = std::find_if(cfs.begin(), cfs.end(),
+                          [](const auto& d) { return d.name == rocksdb::kDefaultColumnFamilyName; });
+  o = rocksdb::Options(dbo, def != cfs.end() ? def->options : rocksdb::ColumnFamilyOptions());
+
+  if (!packed24) {
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.find("merge_operator") != std::string::npos &&
+          line.find(Packed24Merge().Name()) != std::string::npos) {
+        packed24 = true;
+        break;
+      }
+    }
+  }
+  if (packed24) o.merge_operator.reset(new Packed24Merge());
+}
+
+// Overlay on top of the chosen profile. Either inline RocksDB option strings
+// ("write_buffer_size=128M;block_based_table_factory={block_size=32K}") or INI text with
+// [DBOptions], [CFOptions ...] and [TableOptions/BlockBasedTable ...] sections, the
+// layout of RocksDB's own OPTIONS files.
+static void apply_overlay(const std::string& overlay, rocksdb::Options& o) {
+  if (trim(overlay).empty()) return;
+
+  rocksdb::ConfigOptions cfg;
+  cfg.ignore_unknown_options = false;
+  cfg.input_strings_escaped = false;
+
+  const bool ini = trim(overlay).front() == '[' || overlay.find("\n[") != std::string::npos;
+  if (!ini) {
+    rocksdb::Options out;
+    check_options_status(rocksdb::GetOptionsFromString(cfg, o, overlay, &out), "Options overlay");
+    o = out;
+    return;
+  }
+
+  std::string db_str, cf_str, table_str;
+  std::string* cur = nullptr;
+  bool in_version = false;  // [Version] contents are skipped; before any section they are an error
+  size_t lineno = 0;
+  size_t pos = 0;
+  while (pos <= overlay.size()) {
+    size_t nl = overlay.find('\n', pos);
+    if (nl == std::string::npos) nl = overlay.size();
+    const std::string line = trim(std::string_view(overlay).substr(pos, nl - pos));
+    pos = nl + 1;
+    ++lineno;
+    if (line.empty() || line[0] == '#') continue;
+
+    if (line.front() == '[') {
+      in_version = line.rfind("[Version", 0) == 0;
+      if (line.rfind("[DBOptions", 0) == 0)                        cur = &db_str;
+      else if (line.rfind("[CFOptions", 0) == 0)                   cur = &cf_str;
+      else if (line.rfind("[TableOptions/BlockBasedTable", 0) == 0) cur = &table_str;
+      else if (in_version)                                         cur = nullptr;
+      else throw std::invalid_argument("Options overlay line " + std::to_string(lineno) +
+                                       ": unknown section " + line);
+      continue;
+    }
+    const auto eq = line.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("Options overlay line " + std::to_string(lineno) + ": expected key=value");
+    }
+    if (in_version) continue;
+    if (cur == nullptr) {
+      throw std::invalid_argument("Options overlay line " + std::to_string(lineno) +
+                                  ": option outside a section: " + line);
+    }
+    *cur += trim(std::string_view(line).substr(0, eq)) + "=" + trim(std::string_view(line).substr(eq + 1)) + ";";
+  }
+
+  rocksdb::DBOptions dbo(o);
+  rocksdb::ColumnFamilyOptions cfo(o);
+  if (!db_str.empty()) {
+    check_options_status(rocksdb::GetDBOptionsFromString(cfg, rocksdb::DBOptions(o), db_str, &dbo), "[DBOptions]");
+  }
+  if (!cf_str.empty()) {
+    check_options_status(rocksdb::GetColumnFamilyOptionsFromString(cfg, rocksdb::ColumnFamilyOptions(o), cf_str, &cfo),
+                         "[CFOptions]");
+  }
+  if (!table_str.empty()) {
+    auto* cur_bbt = cfo.table_factory ? cfo.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>() : nullptr;
+    if (cur_bbt == nullptr) throw std::invalid_argument("[TableOptions/BlockBasedTable]: profile has no block-based table");
+    rocksdb::BlockBasedTableOptions bbt;
+    check_options_status(rocksdb::GetBlockBasedTableOptionsFromString(cfg, *cur_bbt, table_str, &bbt),
+                         "[TableOptions/BlockBasedTable]");
+    cfo.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbt));
+  }
+  o = rocksdb::Options(dbo, cfo);
+}
+
+// ---------------- Hardware sizing ----------------
+// The fixed numbers in apply_profile assume a 48-CPU / 64 GiB reference node. Smaller
+// nodes (containers, pinned workers) get them scaled down proportionally; larger
+// nodes keep them as they are.
+constexpr unsigned kRefCpus   = 48;
+constexpr uint64_t kRefMemory = 64ull << 30;
+
+static std::optional<std::string> read_line(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) return std::nullopt;
+  std::string line;
+  std::getline(in, line);
+  return trim(line);
+}
+
+// Kernel cpu/node lists: "0-23,48-71"
+static std::vector<unsigned> parse_id_list(const std::string& s) {
+  std::vector<unsigned> out;
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t comma = s.find(',', pos);
+    if (comma == std::string::npos) comma = s.size();
+    const std::string item = trim(std::string_view(s).substr(pos, comma - pos));
+    pos = comma + 1;
+    if (item.empty()) continue;
+    const auto dash = item.find('-');
+    const unsigned long lo = std::strtoul(item.c_str(), nullptr, 10);
+    const unsigned long hi = dash == std::string::npos ? lo : std::strtoul(item.c_str() + dash + 1, nullptr, 10);
+    for (unsigned long id = lo; id <= hi && id < 65536; ++id) out.push_back(static_cast<unsigned>(id));
+  }
+  return out;
+}
+
+// This process's cgroup for a v1 controller ("memory", "cpu"), or the v2 unified one ("").
+static std::optional<std::string> cgroup_of(const std::string& controller) {
+  std::ifstream in("/proc/self/cgroup");
+  std::string line;
+  while (std::getline(in, line)) {
+    // hierarchy-id:controller,list:path
+    const auto c1 = line.find(':');
+    const auto c2 = c1 == std::string::npos ? c1 : line.find(':', c1 + 1);
+    if (c2 == std::string::npos) continue;
+    const std::string ctrls = "," + line.substr(c1 + 1, c2 - c1 - 1) + ",";
+    const bool match = controller.empty() ? ctrls == ",," : ctrls.find("," + controller + ",") != std::string::npos;
+    if (match) return line.substr(c2 + 1);
+  }
+  return std::nullopt;
+}
+
+// Tightest limit from our cgroup up to the root of the mounted hierarchy. Without a
+// cgroup namespace the recorded path may not exist under the mount, so every ancestor
+// is tried. read(dir) returns 0 for "no limit here".
+template <class Read>
+static uint64_t cgroup_min(const std::string& root, std::string rel, Read read) {
+  uint64_t best = 0;
+  for (;;) {
+    while (!rel.empty() && rel.back() == '/') rel.pop_back();
+    const uint64_t v = read(root + rel);
+    if (v != 0 && (best == 0 || v < best)) best = v;
+    if (rel.empty()) break;
+    rel.resize(rel.find_last_of('/') == std::string::npos ? 0 : rel.find_last_of('/'));
+  }
+  return best;
+}
+
+static uint64_t to_u64(const std::optional<std::string>& s) {
+  return s && !s->empty() && std::isdigit(static_cast<unsigned char>((*s)[0])) ? std::strtoull(s->c_str(), nullptr, 10) : 0;
+}
+
+// cgroup CPU quota in milli-CPUs (0 = none)
+static uint64_t cgroup_cpu_millis() {
+  if (auto rel = cgroup_of("cpu")) {
+    return cgroup_min("/sys/fs/cgroup/cpu", *rel, [](const std::string& dir) -> uint64_t {
+      const auto quota = read_line(dir + "/cpu.cfs_quota_us");  // -1 = unlimited
+      const uint64_t period = to_u64(read_line(dir + "/cpu.cfs_period_us"));
+      const uint64_t q = to_u64(quota);
+      return q && period ? q * 1000 / period : 0;
+    });
+  }
+  if (auto rel = cgroup_of("")) {
+    return cgroup_min("/sys/fs/cgroup", *rel, [](const std::string& dir) -> uint64_t {
+      const auto line = read_line(dir + "/cpu.max");  // "max 100000" | "<quota> <period>"
+      if (!line) return 0;
+      const auto sp = line->find(' ');
+      const uint64_t q = to_u64(line->substr(0, sp));
+      const uint64_t period = sp == std::string::npos ? 100000 : to_u64(line->substr(sp + 1));
+      return q && period ? q * 1000 / period : 0;
+    });
+  }
+  return 0;
+}
+
+// cgroup memory limit in bytes (0 = none)
+static uint64_t cgroup_memory_limit() {
+  if (auto rel = cgroup_of("memory")) {
+    // v1 reports "unlimited" as a huge page-aligned number; the caller caps it at physical RAM
+    return cgroup_min("/sys/fs/cgroup/memory", *rel, [](const std::string& dir) {
+      return to_u64(read_line(dir + "/memory.limit_in_bytes"));
+    });
+  }
+  if (auto rel = cgroup_of("")) {
+    return cgroup_min("/sys/fs/cgroup", *rel, [](const std::string& dir) {
+      return to_u64(read_line(dir + "/memory.max"));  // "max" parses as 0
+    });
+  }
+  return 0;
+}
+
+// Hardware a profile should size itself for: OpenArgs overrides, else what was detected.
+struct Sizing {
+  unsigned cpus;
+  uint64_t memory;
+
+  static Sizing For(const OpenArgs& a) {
+    Sizing s{a.cpus, a.memory_bytes};
+    if (s.cpus == 0 || s.memory == 0) {
+      const HardwareInfo hw = DetectHardware();
+      if (s.cpus == 0) s.cpus = hw.cpus;
+      if (s.memory == 0) s.memory = hw.memory_bytes;
+    }
+    return s;
+  }
+
+  // Thread counts tuned for kRefCpus, never below `floor`
+  int Threads(int ref, int floor = 1) const {
+    const double f = std::min(1.0, double(cpus) / kRefCpus);
+    return std::max<int>(floor, static_cast<int>(std::lround(ref * f)));
+  }
+
+  // Byte budgets tuned for kRefMemory, never below `floor`
+  uint64_t Bytes(uint64_t ref, uint64_t floor) const {
+    const double f = std::min(1.0, double(memory) / kRefMemory);
+    return std::max<uint64_t>(floor, static_cast<uint64_t>(ref * f));
+  }
+};
+
+// ---------------- Block cache ----------------
+static std::shared_ptr<rocksdb::SecondaryCache> make_secondary_cache(uint64_t capacity) {
+  if (capacity == 0) return nullptr;
+  rocksdb::CompressedSecondaryCacheOptions so;
+  so.capacity = capacity;
+  so.compression_type = rocksdb::kLZ4Compression;  // cheap to decompress on a hit
+  return rocksdb::NewCompressedSecondaryCache(so);
+}
+
+static std::shared_ptr<rocksdb::Cache> make_block_cache(const BlockCacheArgs& a,
+                                                        std::shared_ptr<rocksdb::SecondaryCache> secondary) {
+  if (a.type == "hyper_clock") {
+    // Lock-free lookups; estimated_entry_charge = 0 selects the auto-sized table. Clock
+    // eviction keeps index/filter priority but has no separate high-pri pool to size.
+    rocksdb::HyperClockCacheOptions co(a.capacity, /*estimated_entry_charge=*/0, a.num_shard_bits,
+                                       a.strict_capacity_limit);
+    co.secondary_cache = std::move(secondary);
+    return co.MakeSharedCache();
+  }
+  if (a.type != "lru") {
+    throw std::invalid_argument("Unknown block cache type: '" + a.type + "'. Valid types: lru, hyper_clock");
+  }
+  if (a.high_pri_pool_ratio < 0 || a.high_pri_pool_ratio > 1) {
+    throw std::invalid_argument("high_pri_pool_ratio must be within [0, 1]");
+  }
+  rocksdb::LRUCacheOptions co;
+  co.capacity = a.capacity;
+  co.num_shard_bits = a.num_shard_bits;
+  co.strict_capacity_limit = a.strict_capacity_limit;
+  co.high_pri_pool_ratio = a.high_pri_pool_ratio;
+  co.secondary_cache = std::move(secondary);
+  return rocksdb::NewLRUCache(co);
+}
+
+static std::shared_ptr<rocksdb::Cache> make_block_cache(const BlockCacheArgs& a) {
+  return make_block_cache(a, make_secondary_cache(a.secondary_capacity));
+}
+
+struct BlockCacheImpl : public BlockCache {
+  BlockCacheArgs args;
+  std::shared_ptr<rocksdb::SecondaryCache> secondary;
+  std::shared_ptr<rocksdb::Cache> cache;
+
+  explicit BlockCacheImpl(const BlockCacheArgs& a)
+      : args(a), secondary(make_secondary_cache(a.secondary_capacity)), cache(make_block_cache(a, secondary)) {}
+
+  const BlockCacheArgs& Args() const override { return args; }
+  size_t Capacity() const override { return cache->GetCapacity(); }
+  void SetCapacity(size_t bytes) override {
+    cache->SetCapacity(bytes);
+    args.capacity = bytes;
+  }
+  size_t Usage() const override { return cache->GetUsage(); }
+  size_t PinnedUsage() const override { return cache->GetPinnedUsage(); }
+  size_t SecondaryUsage() const override {
+    size_t usage = 0;
+    if (secondary) secondary->GetUsage(usage);  // leaves 0 if unsupported
+    return usage;
+  }
+};
+
+// The shim's own implementation behind a public handle; another implementation of the
+// interface carries no RocksDB object to hand over.
+template <class Impl, class Iface>
+const Impl& impl_of(const Iface& handle, const char* what) {
+  auto* impl = dynamic_cast<const Impl*>(&handle);
+  if (impl == nullptr) throw std::invalid_argument(std::string(what) + " must come from rocks_shim, not another implementation");
+  return *impl;
+}
+
+struct WriteBufferManagerImpl : public WriteBufferManager {
+  WriteBufferManagerArgs args;
+  std::shared_ptr<rocksdb::WriteBufferManager> wbm;
+
+  explicit WriteBufferManagerImpl(const WriteBufferManagerArgs& a) : args(a) {
+    if (a.buffer_size == 0) throw std::invalid_argument("WriteBufferManager buffer_size must be > 0");
+    std::shared_ptr<rocksdb::Cache> cache;
+    if (a.cost_to_cache) cache = impl_of<BlockCacheImpl>(*a.cost_to_cache, "cost_to_cache").cache;
+    wbm = std::make_shared<rocksdb::WriteBufferManager>(a.buffer_size, cache, a.allow_stall);
+  }
+
+  const WriteBufferManagerArgs& Args() const override { return args; }
+  size_t BufferSize() const override { return wbm->buffer_size(); }
+  void SetBufferSize(size_t bytes) override {
+    if (bytes == 0) throw std::invalid_argument("WriteBufferManager buffer_size must be > 0");
+    wbm->SetBufferSize(bytes);
+    args.buffer_size = bytes;
+  }
+  void SetAllowStall(bool allow) override {
+    wbm->SetAllowStall(allow);
+    args.allow_stall = allow;
+  }
+  size_t MemoryUsage() const override { return wbm->memory_usage(); }
+  size_t MutableMemoryUsage() const override { return wbm->mutable_memtable_memory_usage(); }
+};
+
+// "Unlimited" background I/O. Every DB gets a rate limiter so SetIoRateLimit works without a
+// reopen; at this rate it never makes a request wait.
+constexpr int64_t kUnlimitedIoRate = int64_t(1) << 40;  // 1 TiB/s
+
+// Common tail of every profile: user overlay, then the shared cache, memtable budget and
+// rate limiter (an overlay cannot name those objects), then ticker statistics if asked for.
+static void finish_profile(const OpenArgs& a, rocksdb::Options& o) {
+  apply_overlay(a.options_overlay, o);
+
+  if (a.block_cache) {
+    auto* cur = o.table_factory ? o.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>() : nullptr;
+    if (cur == nullptr) throw std::invalid_argument("block_cache needs a block-based table");
+    rocksdb::BlockBasedTableOptions bbt = *cur;
+    bbt.block_cache = impl_of<BlockCacheImpl>(*a.block_cache, "block_cache").cache;
+    bbt.no_block_cache = false;
+    o.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbt));
+  }
+
+  if (a.write_buffer_manager) {
+    o.write_buffer_manager = impl_of<WriteBufferManagerImpl>(*a.write_buffer_manager, "write_buffer_manager").wbm;
+  }
+
+  if (a.io_rate_auto_tune && a.io_rate_limit == 0) {
+    throw std::invalid_argument("io_rate_auto_tune needs an io_rate_limit ceiling");
+  }
+  o.rate_limiter.reset(rocksdb::NewGenericRateLimiter(
+      a.io_rate_limit > 0 ? static_cast<int64_t>(a.io_rate_limit) : kUnlimitedIoRate,
+      /*refill_period_us=*/100 * 1000, /*fairness=*/10,
+      rocksdb::RateLimiter::Mode::kAllIo,  // compaction reads compete with Get for the device too
+      a.io_rate_auto_tune));
+
+  if (a.statistics && !o.statistics) {
+    o.statistics = rocksdb::CreateDBStatistics();
+    o.statistics->set_stats_level(rocksdb::StatsLevel::kExceptHistogramOrTimers);  // tickers only: cheap per-core counters
+  }
+}
+
 // ---------------- Enhanced Options helper ----------------
 inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
-  // Core toggles (profile-agnostic)
-  o.create_if_missing = a.read_only ? false : a.create_if_missing;
-  o.level_compaction_dynamic_level_bytes = true;
-
   // Get base profile and suffix
   const std::string base = base_profile(a.profile);
   const std::string msuf = merge_suffix(a.profile);
 
+  // Saved RocksDB options replace the built-in profiles wholesale
+  if (base == "file") {
+    // The file brings its own table options; there is no profile cache for these to shape
+    if (!a.cache_type.empty() || a.secondary_cache_bytes != 0) {
+      throw std::invalid_argument("cache_type and secondary_cache do not apply to a file: profile; "
+                                  "pass a block_cache or set the cache in the options file");
+    }
+    load_options_file(a.profile.substr(base.size() + 1), o);
+    o.create_if_missing = a.read_only ? false : a.create_if_missing;
+    finish_profile(a, o);
+    return;
+  }
+
+  const Sizing hw = Sizing::For(a);
+
+  // Core toggles (profile-agnostic)
+  o.create_if_missing = a.read_only ? false : a.create_if_missing;
+  o.level_compaction_dynamic_level_bytes = true;
+
   // Validate base profile first
-  if (base != "read" && base != "write") {
-    throw std::invalid_argument("Unknown profile: '" + a.profile + "'. Valid profiles: read, write");
+  if (base != "read" && base != "write" && base != "ingest-universal") {
+    throw std::invalid_argument("Unknown profile: '" + a.profile +
+                                "'. Valid profiles: read, write, ingest-universal, file:<path>");
   }
 
   // Merge operator by profile suffix
@@ -117,18 +1543,18 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
   if (base == "read") {
     // -------- Files / I/O path (NVMe assumed)
     o.max_open_files = -1;                            // keep file handles hot
-    o.max_file_opening_threads = 8;                   // plenty; higher rarely helps
+    o.max_file_opening_threads = hw.Threads(8);       // plenty; higher rarely helps
     o.allow_mmap_reads = false;                       // let RocksDB (not OS) cache data
     o.use_direct_reads = true;                        // bypass page cache for reads
     o.use_direct_io_for_flush_and_compaction = true;  // ditto for write path ops
     o.bytes_per_sync = 1 << 20;                       // smooth compaction writeback (1 MiB)
     o.compaction_readahead_size = 0;                  // NVMe: explicit readahead not helpful
 
-    // -------- Concurrency / background work
-    o.max_background_jobs = 36;                       // total (compactions + flush)
-    o.max_background_compactions = 28;
-    o.max_background_flushes = 8;
-    o.max_subcompactions = 20;
+    // -------- Concurrency / background work (48-CPU values, scaled to this node)
+    o.max_background_jobs = hw.Threads(36, 2);        // total (compactions + flush)
+    o.max_background_compactions = hw.Threads(28);
+    o.max_background_flushes = hw.Threads(8);
+    o.max_subcompactions = hw.Threads(20);
     o.use_adaptive_mutex = true;
 
     // -------- LSM shape / compaction posture
@@ -142,7 +1568,7 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
     o.max_bytes_for_level_base = 2ull << 30;          // 2 GiB L1 base
 
     // -------- Memtables (keep modest but not tiny)
-    o.write_buffer_size = 64ull << 20;                // 64 MiB per memtable
+    o.write_buffer_size = hw.Bytes(64ull << 20, 16ull << 20);  // 64 MiB per memtable
     o.max_write_buffer_number = 3;
     o.min_write_buffer_number_to_merge = 1;
     o.allow_concurrent_memtable_write = true;
@@ -181,14 +1607,16 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
     // Checksums
     bbt.checksum = rocksdb::kXXH3;
 
-    // Block cache (RAM budget)
-    {
-      rocksdb::LRUCacheOptions cache_opts;
-      cache_opts.capacity = 4ull << 30;               // 4 GiB (good for many workers)
-      cache_opts.num_shard_bits = 6;                  // better for 4GB cache
-      cache_opts.strict_capacity_limit = false;       // avoid cache runaway
-      cache_opts.high_pri_pool_ratio = 0.30;          // 30% reserved for index/filter/hot
-      bbt.block_cache = rocksdb::NewLRUCache(cache_opts);
+    // Block cache (RAM budget); a shared OpenArgs::block_cache takes its place
+    if (!a.block_cache) {
+      BlockCacheArgs ca;
+      ca.capacity = hw.Bytes(4ull << 30, 64ull << 20);  // 4 GiB on 64 GiB (good for many workers)
+      ca.type = a.cache_type.empty() ? "lru" : a.cache_type;
+      ca.num_shard_bits = ca.type == "lru" ? 6 : -1;    // better for 4GB cache; clock sizes itself
+      ca.strict_capacity_limit = false;                 // avoid cache runaway
+      ca.high_pri_pool_ratio = 0.30;                    // 30% reserved for index/filter/hot
+      ca.secondary_capacity = a.secondary_cache_bytes;
+      bbt.block_cache = make_block_cache(ca);
     }
 
     o.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbt));
@@ -220,10 +1648,10 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
     o.two_write_queues = true;
     o.unordered_write = true;                         // flip to false if you need global order
 
-    o.max_background_jobs = 36;
-    o.max_background_compactions = 28;                // harmless while disabled; useful if you flip later
-    o.max_background_flushes = 8;
-    o.max_subcompactions = 28;
+    o.max_background_jobs = hw.Threads(36, 2);
+    o.max_background_compactions = hw.Threads(28);    // harmless while disabled; useful if you flip later
+    o.max_background_flushes = hw.Threads(8);
+    o.max_subcompactions = hw.Threads(28);
 
     // -------- LSM posture for bulk ingest (let L0 grow without stalling)
     o.compaction_pri = rocksdb::kByCompensatedSize;
@@ -237,8 +1665,10 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
 
     // -------- Memtables / WAL
     o.allow_concurrent_memtable_write = true;
-    o.write_buffer_size = 1ull << 30;       // 1 GiB
-    o.max_write_buffer_number = 16;         // Up to ~6 GiB total
+    // 16 x 1 GiB on 64 GiB: memtables may take a quarter of the memory budget
+    o.write_buffer_size = hw.Bytes(1ull << 30, 64ull << 20);
+    o.max_write_buffer_number = static_cast<int>(
+        std::clamp<uint64_t>(hw.Bytes(16ull << 30, 0) / o.write_buffer_size, 3, 16));
     o.max_total_wal_size = 16ull << 30;     // 16 GiB WAL
     o.min_write_buffer_number_to_merge = 2;
 
@@ -263,99 +1693,369 @@ inline void apply_profile(const OpenArgs& a, rocksdb::Options& o) {
     bbt.checksum = rocksdb::kXXH3;
 
     // Cache can be small; we're not optimizing reads now
+    if (!a.block_cache) {
+      BlockCacheArgs ca;
+      ca.capacity = hw.Bytes(4ull << 30, 64ull << 20);  // 4 GiB on 64 GiB
+      ca.type = a.cache_type.empty() ? "lru" : a.cache_type;
+      ca.num_shard_bits = ca.type == "lru" ? 6 : -1;
+      ca.strict_capacity_limit = false;
+      ca.high_pri_pool_ratio = 0.20;
+      ca.secondary_capacity = a.secondary_cache_bytes;
+      bbt.block_cache = make_block_cache(ca);
+    }
+
+    bbt.cache_index_and_filter_blocks = true;
+    bbt.cache_index_and_filter_blocks_with_high_priority = true;
+    bbt.pin_top_level_index_and_filter = true;
+
+    o.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbt));
+
+    // -------- Housekeeping
+    o.max_open_files = -1;
+    o.max_file_opening_threads = hw.Threads(8);
+    o.stats_dump_period_sec = 60;
+    o.skip_stats_update_on_db_open = false;
+
+  } else if (base == "ingest-universal") {
+    // Continuous ingest that stays readable: universal compaction runs in the background and
+    // keeps the number of sorted runs bounded, so there is neither an unbounded L0 nor one
+    // giant rewrite at the end.
+
+    // -------- I/O
+    o.allow_mmap_reads = false;
+    o.use_direct_reads = false;
+    o.use_direct_io_for_flush_and_compaction = true;  // avoid page-cache trashing
+    o.bytes_per_sync = 1 << 20;
+    o.wal_bytes_per_sync = 1 << 20;
+    o.compaction_readahead_size = 2 << 20;            // universal merges stream whole runs
+
+    // -------- Concurrency
+    o.use_adaptive_mutex = true;
+    o.enable_pipelined_write = true;                  // WAL stays on for continuous ingest
+    o.allow_concurrent_memtable_write = true;
+    o.max_background_jobs = hw.Threads(36, 2);
+    o.max_background_compactions = hw.Threads(28);
+    o.max_background_flushes = hw.Threads(8);
+    o.max_subcompactions = hw.Threads(16);            // splits the large merges across threads
+
+    // -------- Universal compaction (low write amplification)
+    o.compaction_style = rocksdb::kCompactionStyleUniversal;
+    o.level_compaction_dynamic_level_bytes = false;   // leveled-only option
+    o.num_levels = 7;                                 // runs past L0 live in levels: more parallel merges
+    o.disable_auto_compactions = false;
     {
-      rocksdb::LRUCacheOptions cache_opts;
-      cache_opts.capacity = 4ull << 30;                       // 4 GiB
-      cache_opts.num_shard_bits = 6;
-      cache_opts.strict_capacity_limit = false;
-      cache_opts.high_pri_pool_ratio = 0.20;
-      bbt.block_cache = rocksdb::NewLRUCache(cache_opts);
+      rocksdb::CompactionOptionsUniversal u;
+      u.size_ratio = 1;                               // merge runs only when sizes are close
+      u.min_merge_width = 2;
+      u.max_merge_width = UINT_MAX;
+      u.max_size_amplification_percent = 200;         // trade space for fewer full merges
+      u.compression_size_percent = -1;                // compress every run
+      u.stop_style = rocksdb::kCompactionStopStyleTotalSize;
+      u.allow_trivial_move = true;                    // non-overlapping runs (sorted ingest) move for free
+      o.compaction_options_universal = u;
+    }
+
+    // -------- Bounded sorted runs: what a read has to look at
+    o.level0_file_num_compaction_trigger = 8;
+    o.level0_slowdown_writes_trigger     = 20;
+    o.level0_stop_writes_trigger         = 36;
+
+    // -------- Memtables / WAL
+    o.write_buffer_size = hw.Bytes(256ull << 20, 64ull << 20);  // 256 MiB on 64 GiB
+    o.max_write_buffer_number = 6;
+    o.min_write_buffer_number_to_merge = 2;
+    o.max_total_wal_size = 4ull << 30;
+
+    // -------- Compression
+    o.compression = rocksdb::kLZ4Compression;
+    o.bottommost_compression = rocksdb::kZSTD;        // the full-size run
+    {
+      rocksdb::CompressionOptions comp_opts;
+      comp_opts.level = 3;
+      comp_opts.max_dict_bytes = 0;
+      o.compression_opts = comp_opts;
     }
 
+    // -------- Table options: filters from the start, so reads during ingest stay cheap
+    rocksdb::BlockBasedTableOptions bbt;
+    bbt.format_version = 5;
+    bbt.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    bbt.partition_filters = true;
     bbt.cache_index_and_filter_blocks = true;
     bbt.cache_index_and_filter_blocks_with_high_priority = true;
     bbt.pin_top_level_index_and_filter = true;
+    bbt.pin_l0_filter_and_index_blocks_in_cache = true;
+    bbt.filter_policy.reset(rocksdb::NewBloomFilterPolicy(/*bits_per_key=*/10, /*use_block_based=*/false));
+    bbt.whole_key_filtering = true;
+    bbt.block_size = 16 * 1024;
+    bbt.checksum = rocksdb::kXXH3;
+
+    if (!a.block_cache) {
+      BlockCacheArgs ca;
+      ca.capacity = hw.Bytes(4ull << 30, 64ull << 20);  // 4 GiB on 64 GiB
+      ca.type = a.cache_type.empty() ? "lru" : a.cache_type;
+      ca.num_shard_bits = ca.type == "lru" ? 6 : -1;
+      ca.high_pri_pool_ratio = 0.30;
+      ca.secondary_capacity = a.secondary_cache_bytes;
+      bbt.block_cache = make_block_cache(ca);
+    }
 
     o.table_factory.reset(rocksdb::NewBlockBasedTableFactory(bbt));
 
     // -------- Housekeeping
     o.max_open_files = -1;
-    o.max_file_opening_threads = 8;
+    o.max_file_opening_threads = hw.Threads(8);
     o.stats_dump_period_sec = 60;
     o.skip_stats_update_on_db_open = false;
   }
+
+  finish_profile(a, o);
 };
 
 // ---------------- DB impl ----------------
+template <class T>
+static void track(std::vector<std::weak_ptr<T>>& list, const std::shared_ptr<T>& p) {
+  list.erase(std::remove_if(list.begin(), list.end(), [](const auto& w) { return w.expired(); }), list.end());
+  list.push_back(p);
+}
+
 struct DbImpl : public DB {
   std::unique_ptr<rocksdb::DB> db;
   OpenArgs args;
+  std::shared_ptr<WriteSignal> signal = std::make_shared<WriteSignal>();
+  std::shared_ptr<rocksdb::MergeOperator> merge_op;
+
+  // Children holding the raw rocksdb::DB*. Close() drains and stops the ones with threads;
+  // FinalizeForRead() refuses to swap the DB while any of them (or a pinned value) is alive.
+  std::mutex children_mu;
+  std::vector<std::weak_ptr<WriterPoolImpl>> pools;
+  std::vector<std::weak_ptr<AutoWbImpl>> auto_batches;
+  std::vector<std::weak_ptr<void>> handles;  // iterators and write batches
+  std::shared_ptr<const void> pin_token = std::make_shared<int>(0);
 
   DbImpl(std::unique_ptr<rocksdb::DB> d, OpenArgs a)
-      : db(std::move(d)), args(std::move(a)) {}
+      : db(std::move(d)), args(std::move(a)), merge_op(db->GetOptions().merge_operator) {}
+
+  ~DbImpl() override { Shutdown(); }
+
+  rocksdb::DB* Live() const {
+    if (!db) throw std::runtime_error("DB is closed");
+    return db.get();
+  }
 
-  [[nodiscard]] bool Get(const std::string& k, std::string* out) override {
-    rocksdb::ReadOptions ro;
-    auto s = db->Get(ro, k, out);
+  [[nodiscard]] bool Get(std::string_view k, std::string* out, const ReadArgs& ra) override {
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto s = Live()->Get(ro, to_slice(k), out);
     if (s.IsNotFound()) return false;
-    if (!s.ok()) throw std::runtime_error(s.ToString());
+    if (!s.ok()) throw_read_status(s);
     return true;
   }
 
-  void Put(const std::string& k, const std::string& v) override {
+  std::shared_ptr<PinnedValue> GetPinned(std::string_view k, const ReadArgs& ra) override {
+    auto pv = std::make_shared<PinnedImpl>();
+    if (!GetSlice(k, &pv->value, ra)) return nullptr;
+    pv->pin = pin_token;
+    return pv;
+  }
+
+  std::optional<size_t> GetInto(std::string_view k, char* buf, size_t cap, const ReadArgs& ra) override {
+    rocksdb::PinnableSlice v;
+    if (!GetSlice(k, &v, ra)) return std::nullopt;
+    if (v.size() <= cap) std::memcpy(buf, v.data(), v.size());
+    return v.size();
+  }
+
+  void Put(std::string_view k, std::string_view v) override {
     rocksdb::WriteOptions wo;
-    auto s = db->Put(wo, k, v);
+    auto s = Live()->Put(wo, to_slice(k), to_slice(v));
     if (!s.ok()) throw std::runtime_error(s.ToString());
+    signal->Notify();
   }
 
-  void Delete(const std::string& k) override {
+  void Delete(std::string_view k) override {
     rocksdb::WriteOptions wo;
-    auto s = db->Delete(wo, k);
+    auto s = Live()->Delete(wo, to_slice(k));
     if (!s.ok()) throw std::runtime_error(s.ToString());
+    signal->Notify();
   }
 
-  void Merge(const std::string& k, const std::string& v) override {
+  void Merge(std::string_view k, std::string_view v) override {
     rocksdb::WriteOptions wo;
-    auto s = db->Merge(wo, k, v);
+    auto s = Live()->Merge(wo, to_slice(k), to_slice(v));
     if (!s.ok()) throw std::runtime_error(s.ToString());
+    signal->Notify();
+  }
+
+  MultiGetResult MultiGet(const std::vector<std::string_view>& keys, const ReadArgs& ra) override {
+    std::vector<rocksdb::Slice> ks;
+    ks.reserve(keys.size());
+    for (const auto& k : keys) ks.push_back(to_slice(k));
+    return MultiGetSlices(ks, ra);
+  }
+
+  MultiGetResult MultiGetBuffers(const PackedSlices& keys, const ReadArgs& ra) override {
+    std::vector<rocksdb::Slice> ks;
+    ks.reserve(keys.count);
+    for (size_t i = 0; i < keys.count; ++i) ks.push_back(to_slice(keys[i]));
+    return MultiGetSlices(ks, ra);
+  }
+
+  std::vector<uint8_t> MayExist(const std::vector<std::string_view>& keys, MultiGetResult* values,
+                                const ReadArgs& ra) override {
+    return MayExistImpl(keys.size(), [&](size_t i) { return to_slice(keys[i]); }, values, ra);
   }
 
-  std::shared_ptr<Iterator> NewIterator() override {
-    rocksdb::ReadOptions ro;
-    return std::make_shared<ItImpl>(std::unique_ptr<rocksdb::Iterator>(db->NewIterator(ro)));
+  std::vector<uint8_t> MayExistBuffers(const PackedSlices& keys, MultiGetResult* values,
+                                       const ReadArgs& ra) override {
+    return MayExistImpl(keys.count, [&](size_t i) { return to_slice(keys[i]); }, values, ra);
+  }
+
+  void DeleteRange(std::string_view begin, std::string_view end, bool drop_files) override {
+    auto b = to_slice(begin);
+    auto e = to_slice(end);
+    DeleteKeyRange(b, &e, drop_files);
+  }
+
+  void DeletePrefix(std::string_view prefix, bool drop_files) override {
+    auto b = to_slice(prefix);
+    if (auto succ = prefix_successor(prefix)) {
+      rocksdb::Slice e(*succ);
+      DeleteKeyRange(b, &e, drop_files);
+    } else {
+      DeleteKeyRange(b, nullptr, drop_files);
+    }
+  }
+
+  std::shared_ptr<Iterator> NewIterator(const ReadArgs& ra) override {
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto seq = Live()->GetLatestSequenceNumber();
+    auto it = std::make_shared<ItImpl>(std::unique_ptr<rocksdb::Iterator>(Live()->NewIterator(ro)),
+                                       Live(), signal, seq, ra.tailing);
+    std::lock_guard<std::mutex> lk(children_mu);
+    track(handles, std::shared_ptr<void>(it));
+    return it;
   }
 
   // Per-batch WAL/sync control
-  std::shared_ptr<WriteBatch> NewWriteBatch(bool disable_wal=false, bool sync=false) override {
-    return std::make_shared<WbImpl>(db.get(), disable_wal, sync);
+  std::shared_ptr<WriteBatch> NewWriteBatch(bool disable_wal, bool sync, bool sort_keys,
+                                            size_t ingest_threshold) override {
+    if (ingest_threshold != 0 && !disable_wal) {
+      throw std::invalid_argument("ingest_threshold requires disable_wal=True");
+    }
+    auto b = std::make_shared<WbImpl>(Live(), signal, merge_op, disable_wal, sync, sort_keys,
+                                      ingest_threshold, args.path + "/.rshim-ingest");
+    std::lock_guard<std::mutex> lk(children_mu);
+    track(handles, std::shared_ptr<void>(b));
+    return b;
+  }
+
+  std::shared_ptr<IndexedWriteBatch> NewIndexedWriteBatch(bool disable_wal, bool sync) override {
+    auto b = std::make_shared<IdxWbImpl>(Live(), signal, disable_wal, sync);
+    std::lock_guard<std::mutex> lk(children_mu);
+    track(handles, std::shared_ptr<void>(b));
+    return b;
+  }
+
+  std::shared_ptr<AutoWriteBatch> NewAutoWriteBatch(size_t max_bytes, size_t max_ops,
+                                                    bool disable_wal, bool sync) override {
+    if (max_bytes == 0 && max_ops == 0) {
+      throw std::invalid_argument("NewAutoWriteBatch needs a byte or operation budget");
+    }
+    auto b = std::make_shared<AutoWbImpl>(Live(), signal, max_bytes == 0 ? SIZE_MAX : max_bytes,
+                                          max_ops, disable_wal, sync);
+    std::lock_guard<std::mutex> lk(children_mu);
+    track(auto_batches, b);
+    return b;
+  }
+
+  std::shared_ptr<WriterPool> NewWriterPool(size_t threads, size_t max_pending,
+                                            bool disable_wal, bool sync) override {
+    auto p = std::make_shared<WriterPoolImpl>(Live(), signal, threads, max_pending, disable_wal, sync);
+    std::lock_guard<std::mutex> lk(children_mu);
+    track(pools, p);
+    return p;
   }
 
   void Close() override {
     if (!db) return;
-    rocksdb::CancelAllBackgroundWork(db.get(), /*wait=*/false);
-    db.reset();
+    // A PinnedValue releases its block-cache handle on destruction; after the DB and its
+    // table cache are gone that would be a use-after-free
+    if (pin_token.use_count() > 1) {
+      throw std::runtime_error("Close: release the pinned values of this DB first");
+    }
+    Shutdown();
   }
 
   // ----- Optional API (wired) -----
   void FinalizeBulk() override {
     // Make any WAL durable if it was enabled (ignore NotSupported).
-    auto st1 = db->FlushWAL(/*sync=*/true);
+    auto st1 = Live()->FlushWAL(/*sync=*/true);
     if (!st1.ok() && !st1.IsNotSupported()) throw std::runtime_error(st1.ToString());
 
     // Flush all memtables to SSTs.
     rocksdb::FlushOptions fo;
     fo.wait = true;
-    auto st2 = db->Flush(fo);
+    auto st2 = Live()->Flush(fo);
     if (!st2.ok()) throw std::runtime_error(st2.ToString());
   }
 
+  void FinalizeForRead() override {
+    if (args.read_only) throw std::invalid_argument("FinalizeForRead needs a writable DB");
+    Live();
+    // Held throughout: no new child may pick up the rocksdb::DB* that is about to be replaced
+    std::lock_guard<std::mutex> lk(children_mu);
+    auto alive = [](const auto& list) {
+      return std::any_of(list.begin(), list.end(), [](const auto& w) { return !w.expired(); });
+    };
+    if (alive(handles) || alive(pools) || alive(auto_batches) || pin_token.use_count() > 1) {
+      throw std::runtime_error("FinalizeForRead: release iterators, write batches, writer pools and "
+                               "pinned values of this DB first");
+    }
+    FinalizeBulk();
+
+    OpenArgs ra = args;
+    const bool packed24 = merge_op && std::string(merge_op->Name()) == Packed24Merge().Name();
+    ra.profile = packed24 ? "read:packed24" : "read";
+    ra.options_overlay.clear();  // the overlay tuned the ingest profile
+    ra.create_if_missing = false;
+    rocksdb::Options o;
+    apply_profile(ra, o);
+    o.disable_auto_compactions = true;  // nothing competes with the single full rewrite
+    o.max_subcompactions = std::max<uint32_t>(o.max_subcompactions, Sizing::For(ra).cpus);
+    o.rate_limiter = db->GetDBOptions().rate_limiter;  // keep any SetIoRateLimit change
+
+    const rocksdb::Options prev = db->GetOptions();
+    rocksdb::CancelAllBackgroundWork(db.get(), /*wait=*/true);
+    auto st = db->Close();
+    db.reset();
+    if (!st.ok()) Reopen(prev, st);
+
+    rocksdb::DB* raw = nullptr;
+    st = rocksdb::DB::Open(o, args.path, &raw);
+    if (!st.ok()) Reopen(prev, st);
+    db.reset(raw);
+    args = ra;
+    merge_op = db->GetOptions().merge_operator;
+
+    rocksdb::CompactRangeOptions cro;
+    cro.exclusive_manual_compaction = true;
+    cro.bottommost_level_compaction = rocksdb::BottommostLevelCompaction::kForce;
+    cro.allow_write_stall = true;
+    cro.max_subcompactions = o.max_subcompactions;
+    st = db->CompactRange(cro, nullptr, nullptr);
+    if (!st.ok()) throw std::runtime_error(st.ToString());
+
+    st = db->SetOptions({{"disable_auto_compactions", "false"}});
+    if (!st.ok()) throw std::runtime_error(st.ToString());
+  }
+
   void CompactAll() override {
     rocksdb::CompactRangeOptions cro;
     cro.exclusive_manual_compaction = true;  // Full compaction should be exclusive
     cro.change_level = false;
     cro.bottommost_level_compaction = rocksdb::BottommostLevelCompaction::kForce;
     cro.allow_write_stall = true;
-    auto st = db->CompactRange(cro, nullptr, nullptr);
+    auto st = Live()->CompactRange(cro, nullptr, nullptr);
     if (!st.ok()) throw std::runtime_error(st.ToString());
   }
 
@@ -382,13 +2082,47 @@ struct DbImpl : public DB {
       end_ptr = &end_slice;
     }
 
-    auto st = db->CompactRange(cro, start_ptr, end_ptr);
+    auto st = Live()->CompactRange(cro, start_ptr, end_ptr);
     if (!st.ok()) throw std::runtime_error(st.ToString());
   }
 
+  void SetIoRateLimit(uint64_t bytes_per_sec) override {
+    auto limiter = Live()->GetDBOptions().rate_limiter;
+    if (!limiter) throw std::runtime_error("DB was opened without a rate limiter");
+    limiter->SetBytesPerSecond(bytes_per_sec > 0 ? static_cast<int64_t>(bytes_per_sec) : kUnlimitedIoRate);
+  }
+
+  uint64_t IoRateLimit() override {
+    auto limiter = Live()->GetDBOptions().rate_limiter;
+    if (!limiter) return 0;
+    const int64_t rate = limiter->GetBytesPerSecond();
+    return rate >= kUnlimitedIoRate ? 0 : static_cast<uint64_t>(rate);
+  }
+
+  BlockCacheStats CacheStats() override {
+    BlockCacheStats s;
+    s.shared = args.block_cache != nullptr;
+    const rocksdb::Options o = Live()->GetOptions();
+    auto* bbt = o.table_factory ? o.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>() : nullptr;
+    if (bbt && bbt->block_cache) {
+      s.capacity = bbt->block_cache->GetCapacity();
+      s.usage = bbt->block_cache->GetUsage();
+      s.pinned_usage = bbt->block_cache->GetPinnedUsage();
+    }
+    if (o.statistics) {
+      s.statistics = true;
+      s.hits = o.statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+      s.misses = o.statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+      s.bytes_inserted = o.statistics->getTickerCount(rocksdb::BLOCK_CACHE_BYTES_WRITE);
+      s.bytes_read = o.statistics->getTickerCount(rocksdb::BLOCK_CACHE_BYTES_READ);
+      s.secondary_hits = o.statistics->getTickerCount(rocksdb::SECONDARY_CACHE_HITS);
+    }
+    return s;
+  }
+
   std::optional<std::string> GetProperty(const std::string& name) override {
     std::string out;
-    if (!db->GetProperty(name, &out)) return std::nullopt;
+    if (!Live()->GetProperty(name, &out)) return std::nullopt;
     return out;
   }
 
@@ -397,8 +2131,176 @@ struct DbImpl : public DB {
     rocksdb::IngestExternalFileOptions io;
     io.move_files = move;
     io.write_global_seqno = write_global_seqno;
-    auto st = db->IngestExternalFile(paths, io);
+    auto st = Live()->IngestExternalFile(paths, io);
     if (!st.ok()) throw std::runtime_error(st.ToString());
+    signal->Notify();
+  }
+
+ private:
+  template <class KeyAt>
+  std::vector<uint8_t> MayExistImpl(size_t n, KeyAt key_at, MultiGetResult* values, const ReadArgs& ra) {
+    rocksdb::ReadOptions ro = to_read_options(ra);  // KeyMayExist itself restricts reads to the block cache tier
+    auto* cf = Live()->DefaultColumnFamily();
+    std::vector<uint8_t> out(n);
+    std::string v;
+    if (values != nullptr) {
+      values->data.clear();
+      values->offsets.assign(1, 0);
+      values->offsets.reserve(n + 1);
+      values->found.assign(n, 0);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      bool value_found = false;
+      out[i] = Live()->KeyMayExist(ro, cf, key_at(i), &v, values != nullptr ? &value_found : nullptr);
+      if (values != nullptr) {
+        if (out[i] && value_found) {
+          values->data.append(v);
+          values->found[i] = 1;
+        }
+        values->offsets.push_back(values->data.size());
+      }
+    }
+    return out;
+  }
+
+  bool GetSlice(std::string_view k, rocksdb::PinnableSlice* out, const ReadArgs& ra) {
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto s = Live()->Get(ro, Live()->DefaultColumnFamily(), to_slice(k), out);
+    if (s.IsNotFound()) return false;
+    if (!s.ok()) throw_read_status(s);
+    return true;
+  }
+
+  // Lookups run in key order, kMultiGetChunk keys per rocksdb MultiGet call with
+  // sorted_input set. Unsorted input is sorted through an index permutation first,
+  // so neighbouring keys share block reads across the whole request, not just one chunk.
+  MultiGetResult MultiGetSlices(const std::vector<rocksdb::Slice>& keys, const ReadArgs& ra) {
+    constexpr size_t kMultiGetChunk = 4096;
+    const size_t n = keys.size();
+    auto less = [](const rocksdb::Slice& a, const rocksdb::Slice& b) { return a.compare(b) < 0; };
+    const bool sorted = std::is_sorted(keys.begin(), keys.end(), less);
+
+    std::vector<size_t> order;
+    if (!sorted) {
+      order.resize(n);
+      for (size_t i = 0; i < n; ++i) order[i] = i;
+      parallel_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const int cmp = keys[a].compare(keys[b]);
+        return cmp < 0 || (cmp == 0 && a < b);
+      });
+    }
+
+    rocksdb::ReadOptions ro = to_read_options(ra);
+    auto* cf = Live()->DefaultColumnFamily();
+    const size_t chunk = std::min(n, kMultiGetChunk);
+    std::vector<rocksdb::Slice> ck(chunk);
+    std::vector<rocksdb::PinnableSlice> vals(chunk);
+    std::vector<rocksdb::Status> sts(chunk);
+
+    MultiGetResult res;
+    std::string& blob = res.data;
+    std::vector<uint64_t> pos(n + 1);  // start of each value in blob (lookup order)
+    res.found.assign(n, 0);
+    for (size_t start = 0; start < n; start += chunk) {
+      const size_t m = std::min(chunk, n - start);
+      for (size_t j = 0; j < m; ++j) ck[j] = keys[sorted ? start + j : order[start + j]];
+      Live()->MultiGet(ro, cf, m, ck.data(), vals.data(), sts.data(), /*sorted_input=*/true);
+      for (size_t j = 0; j < m; ++j) {
+        const size_t idx = sorted ? start + j : order[start + j];
+        pos[idx] = blob.size();
+        if (sts[j].ok()) {
+          blob.append(vals[j].data(), vals[j].size());
+          res.found[idx] = 1;
+        } else if (!sts[j].IsNotFound()) {
+          throw_read_status(sts[j]);
+        }
+        vals[j].Reset();
+      }
+    }
+
+    if (sorted) {
+      pos[n] = blob.size();
+      res.offsets = std::move(pos);
+      return res;
+    }
+
+    // Lookup order -> input order: value idx spans [pos[idx], next start in lookup order)
+    std::vector<uint64_t> len(n);
+    for (size_t r = 0; r < n; ++r) {
+      const size_t idx = order[r];
+      const uint64_t end = r + 1 < n ? pos[order[r + 1]] : blob.size();
+      len[idx] = end - pos[idx];
+    }
+    std::string out;
+    out.reserve(blob.size());
+    res.offsets.resize(n + 1);
+    for (size_t i = 0; i < n; ++i) {
+      res.offsets[i] = out.size();
+      out.append(blob, pos[i], len[i]);
+    }
+    res.offsets[n] = out.size();
+    res.data = std::move(out);
+    return res;
+  }
+
+  void Shutdown() {
+    if (!db) return;
+    StopWriters();
+    rocksdb::CancelAllBackgroundWork(db.get(), /*wait=*/false);
+    db.reset();
+  }
+
+  // FinalizeForRead could not switch over: bring the DB back as it was and raise `why`.
+  // If even that fails the handle stays closed and every later call raises "DB is closed".
+  [[noreturn]] void Reopen(const rocksdb::Options& prev, const rocksdb::Status& why) {
+    rocksdb::DB* raw = nullptr;
+    auto st = rocksdb::DB::Open(prev, args.path, &raw);
+    if (!st.ok()) {
+      throw std::runtime_error("FinalizeForRead: " + why.ToString() + "; reopening failed, DB is closed: " +
+                               st.ToString());
+    }
+    db.reset(raw);
+    throw std::runtime_error("FinalizeForRead: " + why.ToString() + " (reopened with the previous options)");
+  }
+
+  // Land everything live pools and auto batches accepted, then stop their threads
+  void StopWriters() {
+    std::lock_guard<std::mutex> lk(children_mu);
+    for (auto& w : pools) {
+      if (auto p = w.lock()) p->Stop();
+    }
+    for (auto& w : auto_batches) {
+      if (auto b = w.lock()) b->Shutdown();
+    }
+  }
+
+  // [b, *e) or, with e == nullptr, [b, end of keyspace)
+  void DeleteKeyRange(const rocksdb::Slice& b, const rocksdb::Slice* e, bool drop_files) {
+    auto* cf = Live()->DefaultColumnFamily();
+    if (drop_files) {
+      auto st = rocksdb::DeleteFilesInRange(Live(), cf, &b, e, /*include_end=*/false);
+      if (!st.ok()) throw std::runtime_error(st.ToString());
+    }
+
+    rocksdb::WriteBatch wb;
+    if (e != nullptr) {
+      wb.DeleteRange(b, *e);
+    } else {
+      // No exclusive upper bound exists: cover [b, last key) and the last key itself.
+      // The last key is read now; one written after it concurrently is not deleted.
+      std::unique_ptr<rocksdb::Iterator> it(Live()->NewIterator(rocksdb::ReadOptions()));
+      it->SeekToLast();
+      if (!it->status().ok()) throw std::runtime_error(it->status().ToString());
+      if (!it->Valid() || it->key().compare(b) < 0) return;
+      std::string last = it->key().ToString();
+      wb.DeleteRange(b, last);
+      wb.Delete(last);
+    }
+
+    rocksdb::WriteOptions wo;
+    auto st = Live()->Write(wo, &wb);
+    if (!st.ok()) throw std::runtime_error(st.ToString());
+    signal->Notify();
   }
 };
 
@@ -420,8 +2322,8 @@ struct SstFileWriterImpl : public SstFileWriter {
     if (!st.ok()) throw std::runtime_error(st.ToString());
   }
 
-  void Put(const std::string& key, const std::string& value) override {
-    auto st = writer->Put(key, value);
+  void Put(std::string_view key, std::string_view value) override {
+    auto st = writer->Put(to_slice(key), to_slice(value));
     if (!st.ok()) throw std::runtime_error(st.ToString());
   }
 
@@ -437,6 +2339,68 @@ struct SstFileWriterImpl : public SstFileWriter {
 
 }  // namespace
 
+HardwareInfo DetectHardware() {
+  HardwareInfo hw;
+
+  // CPUs we may be scheduled on (taskset / numactl / container cpusets)
+  std::vector<bool> allowed;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    allowed.resize(CPU_SETSIZE);
+    for (int c = 0; c < CPU_SETSIZE; ++c) allowed[c] = CPU_ISSET(c, &set);
+    hw.cpus = static_cast<unsigned>(CPU_COUNT(&set));
+  }
+  if (hw.cpus == 0) hw.cpus = std::max(1u, std::thread::hardware_concurrency());
+
+  // Physical RAM, restricted to the NUMA nodes our CPUs are on: a process pinned to one
+  // socket should size its caches for that socket's memory.
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGE_SIZE);
+  hw.memory_bytes = pages > 0 && page_size > 0 ? uint64_t(pages) * uint64_t(page_size) : 0;
+
+  const auto nodes = parse_id_list(read_line("/sys/devices/system/node/online").value_or(""));
+  if (nodes.size() > 1) {
+    hw.numa_nodes = static_cast<unsigned>(nodes.size());
+    unsigned used = 0;
+    for (unsigned n : nodes) {
+      const auto cpus = parse_id_list(read_line("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist").value_or(""));
+      if (allowed.empty() || std::any_of(cpus.begin(), cpus.end(), [&](unsigned c) { return c < allowed.size() && allowed[c]; })) {
+        ++used;
+      }
+    }
+    hw.numa_nodes_used = used > 0 ? used : hw.numa_nodes;
+    hw.memory_bytes = hw.memory_bytes / hw.numa_nodes * hw.numa_nodes_used;
+  }
+
+  // cgroup limits (v1 or v2) cap both
+  if (const uint64_t millis = cgroup_cpu_millis(); millis > 0) {
+    const unsigned quota_cpus = static_cast<unsigned>(std::max<uint64_t>(1, (millis + 999) / 1000));
+    if (quota_cpus < hw.cpus) {
+      hw.cpus = quota_cpus;
+      hw.cpu_limited = true;
+    }
+  }
+  if (const uint64_t limit = cgroup_memory_limit(); limit > 0 && (hw.memory_bytes == 0 || limit < hw.memory_bytes)) {
+    hw.memory_bytes = limit;
+    hw.memory_limited = true;
+  }
+  if (hw.memory_bytes == 0) hw.memory_bytes = kRefMemory;  // unknown: keep the tuned values
+  return hw;
+}
+
+ReadArgs ReadArgs::Preset(const std::string& name) {
+  if (name == "default") return ReadArgs();
+  if (name == "scan") return Scan();
+  if (name == "cache_only") return CacheOnly();
+  if (name == "fast") {
+    ReadArgs r;
+    r.verify_checksums = false;
+    return r;
+  }
+  throw std::invalid_argument("Unknown read preset: " + name + " (expected default, scan, cache_only or fast)");
+}
+
 // -------- Factory --------
 std::shared_ptr<DB> DB::Open(const OpenArgs& args) {
   rocksdb::Options o;
@@ -450,6 +2414,14 @@ std::shared_ptr<DB> DB::Open(const OpenArgs& args) {
   return std::make_shared<DbImpl>(std::unique_ptr<rocksdb::DB>(raw), args);
 }
 
+std::shared_ptr<BlockCache> BlockCache::Create(const BlockCacheArgs& args) {
+  return std::make_shared<BlockCacheImpl>(args);
+}
+
+std::shared_ptr<WriteBufferManager> WriteBufferManager::Create(const WriteBufferManagerArgs& args) {
+  return std::make_shared<WriteBufferManagerImpl>(args);
+}
+
 std::shared_ptr<SstFileWriter> SstFileWriter::Create() {
   return std::make_shared<SstFileWriterImpl>();
 }
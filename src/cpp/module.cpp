@@ -1,13 +1,373 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <rocks_shim/rocks_shim.hpp>
+#include <rocks_shim/thread_pool.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace py = pybind11;
 namespace rs = ::rshim;
 
+namespace {
+
+// Borrow a bytes object's storage (no copy); valid while `b` stays referenced.
+// Call it while holding the GIL, before any gil_scoped_release.
+inline std::string_view view_of(const py::bytes& b) {
+  return {PyBytes_AS_STRING(b.ptr()), static_cast<size_t>(PyBytes_GET_SIZE(b.ptr()))};
+}
+
+// One AutoWriteBatch append: under the GIL unless it is about to wait for the committer
+template <class F>
+void auto_append(rs::AutoWriteBatch& self, size_t bytes, F&& append) {
+  if (self.WouldBlock(bytes)) {
+    py::gil_scoped_release release;
+    append();
+  } else {
+    append();
+  }
+}
+
+bool is_c_contiguous(const py::buffer_info& info) {
+  py::ssize_t expected = info.itemsize;
+  for (py::ssize_t d = info.ndim - 1; d >= 0; --d) {
+    if (info.shape[d] > 1 && info.strides[d] != expected) return false;
+    expected *= info.shape[d];
+  }
+  return true;
+}
+
+// Flat (data, offsets) buffer pair borrowed from Python for the length of one call.
+// 8-byte aligned int64/uint64 offsets are used in place; 32-bit or unaligned ones are
+// widened once. Construct with the GIL held; Validate() may run without it.
+struct PackedArg {
+  py::buffer_info data_info;
+  py::buffer_info off_info;
+  std::vector<uint64_t> widened;
+  rs::PackedSlices view;
+  size_t data_size = 0;
+  const char* what;
+
+  PackedArg(const py::buffer& data, const py::buffer& offsets, const char* name)
+      : data_info(data.request()), off_info(offsets.request()), what(name) {
+    if (!is_c_contiguous(data_info)) {
+      throw std::invalid_argument(std::string(what) + " buffer must be C-contiguous");
+    }
+    data_size = static_cast<size_t>(data_info.size * data_info.itemsize);
+
+    std::string fmt = off_info.format;
+    if (!fmt.empty() && std::strchr("@=<>!", fmt[0])) fmt.erase(0, 1);
+    const bool is_int = fmt.size() == 1 && std::strchr("bBhHiIlLqQnN", fmt[0]);
+    if (off_info.ndim != 1 || !is_int) {
+      throw std::invalid_argument(std::string(what) + " offsets must be a 1-D integer buffer");
+    }
+    const size_t n = static_cast<size_t>(off_info.shape[0]);
+    if (n == 0) {
+      throw std::invalid_argument(std::string(what) + " offsets need count + 1 entries");
+    }
+
+    const auto* base = static_cast<const char*>(off_info.ptr);
+    const py::ssize_t stride = off_info.strides[0];
+    const bool borrow = off_info.itemsize == 8 && stride == 8 &&
+                        reinterpret_cast<uintptr_t>(base) % alignof(uint64_t) == 0;
+    if (borrow) {
+      view.offsets = reinterpret_cast<const uint64_t*>(base);
+    } else {
+      const bool is_signed = std::islower(static_cast<unsigned char>(fmt[0]));
+      widened.resize(n);
+      for (size_t i = 0; i < n; ++i) {
+        const char* p = base + static_cast<py::ssize_t>(i) * stride;
+        int64_t v = 0;
+        switch (off_info.itemsize) {
+          case 1: v = is_signed ? int64_t(*reinterpret_cast<const int8_t*>(p))  : int64_t(*reinterpret_cast<const uint8_t*>(p)); break;
+          case 2: { int16_t s16; uint16_t u16; std::memcpy(&s16, p, 2); std::memcpy(&u16, p, 2); v = is_signed ? s16 : u16; break; }
+          case 4: { int32_t s32; uint32_t u32; std::memcpy(&s32, p, 4); std::memcpy(&u32, p, 4); v = is_signed ? s32 : int64_t(u32); break; }
+          case 8: std::memcpy(&v, p, 8); break;
+          default: throw std::invalid_argument(std::string(what) + " offsets have an unsupported item size");
+        }
+        widened[i] = static_cast<uint64_t>(v);  // negatives become huge and fail Validate()
+      }
+      view.offsets = widened.data();
+    }
+    view.data = static_cast<const char*>(data_info.ptr);
+    view.count = n - 1;
+  }
+
+  // Offsets must be non-decreasing and stay inside the data buffer.
+  void Validate() const {
+    const uint64_t* o = view.offsets;
+    for (size_t i = 0; i < view.count; ++i) {
+      if (o[i] > o[i + 1]) {
+        throw std::invalid_argument(std::string(what) + " offsets must be non-decreasing (index " +
+                                    std::to_string(i) + ")");
+      }
+    }
+    if (o[view.count] > data_size) {
+      throw std::invalid_argument(std::string(what) + " offsets run past the end of the data buffer");
+    }
+  }
+};
+
+// Borrow every key of a Python iterable of bytes; `hold` keeps them referenced.
+std::vector<std::string_view> borrow_keys(const py::object& keys, std::vector<py::bytes>& hold) {
+  std::vector<std::string_view> ks;
+  for (auto k : keys) {
+    ks.push_back(view_of(hold.emplace_back(k.cast<py::bytes>())));
+  }
+  return ks;
+}
+
+// `options=` argument of the read calls: None, a preset name or a ReadOptions
+rs::ReadArgs read_args_of(const py::object& options, const rs::ReadArgs& dflt = rs::ReadArgs()) {
+  if (options.is_none()) return dflt;
+  if (py::isinstance<py::str>(options)) return rs::ReadArgs::Preset(options.cast<std::string>());
+  return options.cast<rs::ReadArgs>();
+}
+
+// Per-call keyword overrides layered over `options`
+void apply_overrides(rs::ReadArgs& ra, std::optional<bool> fill_cache, std::optional<size_t> readahead_size,
+                     std::optional<bool> async_io) {
+  if (fill_cache) ra.fill_cache = *fill_cache;
+  if (readahead_size) ra.readahead_size = *readahead_size;
+  if (async_io) ra.async_io = *async_io;
+}
+
+// multi_get defaults to async I/O
+rs::ReadArgs multi_get_defaults() {
+  rs::ReadArgs ra;
+  ra.async_io = true;
+  return ra;
+}
+
+// MultiGetResult -> [bytes | None, ...]
+py::list values_as_list(const rs::MultiGetResult& res) {
+  py::list out(res.found.size());
+  for (size_t i = 0; i < res.found.size(); ++i) {
+    if (res.found[i]) {
+      out[i] = py::bytes(res.data.data() + res.offsets[i], res.offsets[i + 1] - res.offsets[i]);
+    } else {
+      out[i] = py::none();
+    }
+  }
+  return out;
+}
+
+// 0/1 bytes -> bool memoryview
+py::object mask_view(const std::vector<uint8_t>& mask) {
+  py::bytes b(reinterpret_cast<const char*>(mask.data()), mask.size());
+  return py::memoryview(b).attr("cast")("?");
+}
+
+// MultiGetResult -> (values blob, uint64 offsets memoryview, bool found memoryview)
+py::tuple values_as_packed(const rs::MultiGetResult& res) {
+  py::bytes off(reinterpret_cast<const char*>(res.offsets.data()), res.offsets.size() * sizeof(uint64_t));
+  return py::make_tuple(py::bytes(res.data), py::memoryview(off).attr("cast")("Q"), mask_view(res.found));
+}
+
+// `overlay=` for open(): None, inline option text, a path to an .ini/.json file, or a dict.
+// Dicts of dicts map to sections ({"DBOptions": {...}, "CFOptions": {...},
+// "TableOptions": {...}}); flat dicts become a RocksDB option string.
+std::string overlay_text(const py::object& overlay) {
+  if (overlay.is_none()) return {};
+
+  auto value_text = [](py::handle v) -> std::string {
+    if (py::isinstance<py::bool_>(v)) return v.cast<bool>() ? "true" : "false";
+    return py::str(v).cast<std::string>();
+  };
+
+  if (py::isinstance<py::dict>(overlay)) {
+    std::string flat, ini;
+    for (auto [k, v] : overlay.cast<py::dict>()) {
+      const std::string key = py::str(k).cast<std::string>();
+      if (!py::isinstance<py::dict>(v)) {
+        flat += key + "=" + value_text(v) + ";";
+        continue;
+      }
+      if (key == "DBOptions")         ini += "[DBOptions]\n";
+      else if (key == "CFOptions")    ini += "[CFOptions \"default\"]\n";
+      else if (key == "TableOptions") ini += "[TableOptions/BlockBasedTable \"default\"]\n";
+      else throw std::invalid_argument("overlay section must be DBOptions, CFOptions or TableOptions, not " + key);
+      for (auto [sk, sv] : v.cast<py::dict>()) {
+        ini += py::str(sk).cast<std::string>() + "=" + value_text(sv) + "\n";
+      }
+    }
+    if (!flat.empty() && !ini.empty()) {
+      throw std::invalid_argument("overlay dict mixes sections and plain options");
+    }
+    return flat.empty() ? ini : flat;
+  }
+
+  py::object os_path = py::module_::import("os").attr("path");
+  py::object text = py::module_::import("os").attr("fspath")(overlay);
+  if (os_path.attr("isfile")(text).cast<bool>()) {
+    const std::string path = text.cast<std::string>();
+    py::object f = py::module_::import("builtins").attr("open")(text, "r");
+    py::object content = f.attr("read")();
+    f.attr("close")();
+    if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) {
+      return overlay_text(py::module_::import("json").attr("loads")(content));
+    }
+    return content.cast<std::string>();
+  }
+  return text.cast<std::string>();
+}
+
+// ---------------- asyncio bridge ----------------
+// Async calls run on one process-wide C++ pool. Each event loop gets a LoopBridge: workers
+// queue completions on it and poke a non-blocking pipe, and a loop.add_reader callback
+// resolves the matching futures, so no thread per call and nothing touches Python off-loop.
+
+// Builds the result on the loop thread (GIL held); may throw the job's exception instead.
+using Deliver = std::function<py::object()>;
+
+rs::ThreadPool& async_pool() {
+  static auto* pool = new rs::ThreadPool();  // never destroyed: running jobs must not hold up exit
+  return *pool;
+}
+
+struct CompletionQueue {
+  int rfd = -1, wfd = -1;
+  std::mutex mu;
+  std::vector<std::pair<uint64_t, Deliver>> done;
+  bool armed = false;  // a wakeup byte is pending in the pipe
+
+  CompletionQueue() {
+    int fds[2];
+    if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) throw std::runtime_error("pipe2 failed for asyncio bridge");
+    rfd = fds[0];
+    wfd = fds[1];
+  }
+  ~CompletionQueue() {
+    ::close(rfd);
+    ::close(wfd);
+  }
+
+  void Push(uint64_t id, Deliver d) {  // any thread
+    bool wake;
+    {
+      std::lock_guard<std::mutex> lk(mu);
+      done.emplace_back(id, std::move(d));
+      wake = !armed;
+      armed = true;
+    }
+    if (wake) {
+      const char c = 1;
+      while (::write(wfd, &c, 1) < 0 && errno == EINTR) {}
+    }
+  }
+
+  std::vector<std::pair<uint64_t, Deliver>> Take() {  // loop thread
+    char buf[64];
+    while (::read(rfd, buf, sizeof(buf)) > 0) {}
+    std::lock_guard<std::mutex> lk(mu);
+    armed = false;
+    return std::exchange(done, {});
+  }
+};
+
+struct LoopBridge {
+  std::shared_ptr<CompletionQueue> q = std::make_shared<CompletionQueue>();
+  std::unordered_map<uint64_t, py::object> futures;  // only touched with the GIL held
+  uint64_t next_id = 0;
+
+  void Drain() {
+    for (auto& [id, deliver] : q->Take()) {
+      auto it = futures.find(id);
+      if (it == futures.end()) continue;
+      py::object fut = std::move(it->second);
+      futures.erase(it);
+      if (fut.attr("done")().cast<bool>()) continue;  // cancelled while running
+      try {
+        // Calling through cpp_function applies pybind11's exception translation
+        fut.attr("set_result")(py::cpp_function(std::move(deliver))());
+      } catch (py::error_already_set& e) {
+        fut.attr("set_exception")(e.value());
+      }
+    }
+  }
+};
+
+// One bridge per event loop, dropped together with the loop
+std::shared_ptr<LoopBridge> bridge_for(const py::object& loop) {
+  static auto* bridges = new py::object(py::module_::import("weakref").attr("WeakKeyDictionary")());
+  py::object found = bridges->attr("get")(loop);
+  if (!found.is_none()) return found.cast<std::shared_ptr<LoopBridge>>();
+
+  auto b = std::make_shared<LoopBridge>();
+  loop.attr("add_reader")(b->q->rfd, py::cpp_function([b] { b->Drain(); }));
+  (*bridges)[loop] = py::cast(b);
+  return b;
+}
+
+// Run work() on the pool and return an asyncio future for the running loop. work runs
+// without the GIL and must not touch Python objects; the Deliver it returns does that.
+py::object run_async(std::function<Deliver()> work) {
+  py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+  auto b = bridge_for(loop);
+  py::object fut = loop.attr("create_future")();
+  const uint64_t id = b->next_id++;
+  b->futures.emplace(id, fut);
+
+  async_pool().Submit([q = b->q, id, work = std::move(work)] {
+    Deliver d;
+    try {
+      d = work();
+    } catch (...) {
+      d = [ep = std::current_exception()]() -> py::object { std::rethrow_exception(ep); };
+    }
+    q->Push(id, std::move(d));
+  });
+  return fut;
+}
+
+// Keys copied out of Python for an async call (list or blob + offsets)
+struct OwnedKeys {
+  std::string data;
+  std::vector<uint64_t> offsets{0};
+  bool as_list = false;
+
+  rs::PackedSlices view() const { return {data.data(), offsets.data(), offsets.size() - 1}; }
+};
+
+OwnedKeys copy_keys(const py::object& keys, const py::object& offsets) {
+  OwnedKeys ok;
+  if (offsets.is_none()) {
+    ok.as_list = true;
+    for (auto k : keys) {
+      ok.data += std::string_view(view_of(k.cast<py::bytes>()));
+      ok.offsets.push_back(ok.data.size());
+    }
+    return ok;
+  }
+  PackedArg k(keys.cast<py::buffer>(), offsets.cast<py::buffer>(), "keys");
+  k.Validate();
+  ok.data.assign(k.view.data + k.view.offsets[0], k.view.offsets[k.view.count] - k.view.offsets[0]);
+  ok.offsets.resize(k.view.count + 1);
+  for (size_t i = 0; i <= k.view.count; ++i) ok.offsets[i] = k.view.offsets[i] - k.view.offsets[0];
+  return ok;
+}
+
+}  // namespace
+
 PYBIND11_MODULE(rocks_shim, m) {
   m.doc() = "High-performance RocksDB shim for Python";
 
+  // Per-event-loop completion state for the a* methods (internal)
+  py::class_<LoopBridge, std::shared_ptr<LoopBridge>>(m, "_LoopBridge");
+
   // --- Iterator Bindings ---
   py::class_<rs::Iterator, std::shared_ptr<rs::Iterator>>(m, "Iterator")
     .def("seek", &rs::Iterator::Seek, py::arg("lower"), py::call_guard<py::gil_scoped_release>())
@@ -20,7 +380,120 @@ PYBIND11_MODULE(rocks_shim, m) {
         auto val_sv = self.Value();
         return py::bytes(val_sv.data(), val_sv.size());
      })
-    .def("next", &rs::Iterator::Next, py::call_guard<py::gil_scoped_release>());
+    .def("next", &rs::Iterator::Next, py::call_guard<py::gil_scoped_release>())
+    .def("refresh", &rs::Iterator::Refresh, py::call_guard<py::gil_scoped_release>())
+    .def("wait_for_new", [](rs::Iterator& self, std::optional<double> timeout) {
+        py::gil_scoped_release release;
+        return self.WaitForNew(timeout ? *timeout : -1.0);
+      },
+      py::arg("timeout") = py::none(),
+      "Block until newer writes exist (or timeout seconds pass); returns True if new data arrived");
+
+  // --- ReadOptions Bindings ---
+  py::register_exception<rs::IncompleteError>(m, "IncompleteError", PyExc_RuntimeError);
+  // Subclass of the builtin, so `except TimeoutError` catches it too
+  py::register_exception<rs::TimeoutError>(m, "TimeoutError", PyExc_TimeoutError);
+
+  py::class_<rs::ReadArgs>(m, "ReadOptions")
+    .def(py::init([](bool fill_cache, size_t readahead_size, bool async_io, bool verify_checksums, bool cache_only,
+                     double deadline, double io_timeout) {
+        if (deadline < 0 || io_timeout < 0) throw std::invalid_argument("deadline and io_timeout must be >= 0");
+        rs::ReadArgs ra;
+        ra.fill_cache = fill_cache;
+        ra.readahead_size = readahead_size;
+        ra.async_io = async_io;
+        ra.verify_checksums = verify_checksums;
+        ra.cache_only = cache_only;
+        ra.deadline_sec = deadline;
+        ra.io_timeout_sec = io_timeout;
+        return ra;
+      }),
+      py::kw_only(), py::arg("fill_cache") = true, py::arg("readahead_size") = 0, py::arg("async_io") = false,
+      py::arg("verify_checksums") = true, py::arg("cache_only") = false,
+      py::arg("deadline") = 0.0, py::arg("io_timeout") = 0.0,
+      "deadline/io_timeout are seconds (0 = none): deadline bounds each call, io_timeout each file read")
+    .def_readwrite("fill_cache", &rs::ReadArgs::fill_cache)
+    .def_readwrite("readahead_size", &rs::ReadArgs::readahead_size)
+    .def_readwrite("async_io", &rs::ReadArgs::async_io)
+    .def_readwrite("verify_checksums", &rs::ReadArgs::verify_checksums)
+    .def_readwrite("cache_only", &rs::ReadArgs::cache_only)
+    .def_readwrite("deadline", &rs::ReadArgs::deadline_sec)
+    .def_readwrite("io_timeout", &rs::ReadArgs::io_timeout_sec)
+    .def_static("preset", &rs::ReadArgs::Preset, py::arg("name"),
+                "Named preset: default, scan, cache_only or fast")
+    .def("__repr__", [](const rs::ReadArgs& ra) {
+        return "ReadOptions(fill_cache=" + std::string(ra.fill_cache ? "True" : "False") +
+               ", readahead_size=" + std::to_string(ra.readahead_size) +
+               ", async_io=" + (ra.async_io ? "True" : "False") +
+               ", verify_checksums=" + (ra.verify_checksums ? "True" : "False") +
+               ", cache_only=" + (ra.cache_only ? "True" : "False") +
+               ", deadline=" + std::to_string(ra.deadline_sec) +
+               ", io_timeout=" + std::to_string(ra.io_timeout_sec) + ")";
+      });
+
+  // --- BlockCache Bindings ---
+  py::class_<rs::BlockCache, std::shared_ptr<rs::BlockCache>>(m, "BlockCache")
+    .def(py::init([](uint64_t capacity, const std::string& type, int num_shard_bits, double high_pri_pool_ratio,
+                     bool strict_capacity_limit, uint64_t secondary_capacity) {
+        rs::BlockCacheArgs a;
+        a.capacity = capacity;
+        a.type = type;
+        a.num_shard_bits = num_shard_bits;
+        a.high_pri_pool_ratio = high_pri_pool_ratio;
+        a.strict_capacity_limit = strict_capacity_limit;
+        a.secondary_capacity = secondary_capacity;
+        return rs::BlockCache::Create(a);
+      }),
+      py::arg("capacity"), py::kw_only(), py::arg("type") = "lru", py::arg("num_shard_bits") = -1,
+      py::arg("high_pri_pool_ratio") = 0.3, py::arg("strict_capacity_limit") = false,
+      py::arg("secondary_capacity") = 0,
+      "Block cache to share between DBs: pass it to open(..., block_cache=). secondary_capacity adds an\n"
+      "LZ4-compressed in-memory tier that keeps blocks evicted from the cache")
+    .def_property("capacity", &rs::BlockCache::Capacity, &rs::BlockCache::SetCapacity)
+    .def_property_readonly("type", [](const rs::BlockCache& self) { return self.Args().type; })
+    .def_property_readonly("usage", &rs::BlockCache::Usage)
+    .def_property_readonly("pinned_usage", &rs::BlockCache::PinnedUsage)
+    .def_property_readonly("secondary_usage", &rs::BlockCache::SecondaryUsage)
+    .def("__repr__", [](const rs::BlockCache& self) {
+        return "BlockCache(type=" + self.Args().type + ", capacity=" + std::to_string(self.Capacity()) +
+               ", usage=" + std::to_string(self.Usage()) + ")";
+      });
+
+  // --- WriteBufferManager Bindings ---
+  py::class_<rs::WriteBufferManager, std::shared_ptr<rs::WriteBufferManager>>(m, "WriteBufferManager")
+    .def(py::init([](uint64_t buffer_size, std::shared_ptr<rs::BlockCache> cost_to_cache, bool allow_stall) {
+        rs::WriteBufferManagerArgs a;
+        a.buffer_size = buffer_size;
+        a.cost_to_cache = std::move(cost_to_cache);
+        a.allow_stall = allow_stall;
+        return rs::WriteBufferManager::Create(a);
+      }),
+      py::arg("buffer_size"), py::kw_only(), py::arg("cost_to_cache") = py::none(), py::arg("allow_stall") = true,
+      "Memtable budget shared by the DBs opened with write_buffer_manager=. cost_to_cache charges it to a\n"
+      "BlockCache too; allow_stall holds writers at the limit until flushes catch up")
+    .def_property("buffer_size", &rs::WriteBufferManager::BufferSize, &rs::WriteBufferManager::SetBufferSize)
+    .def_property("allow_stall", [](const rs::WriteBufferManager& self) { return self.Args().allow_stall; },
+                  &rs::WriteBufferManager::SetAllowStall)
+    .def_property_readonly("memory_usage", &rs::WriteBufferManager::MemoryUsage)
+    .def_property_readonly("mutable_memory_usage", &rs::WriteBufferManager::MutableMemoryUsage)
+    .def("__repr__", [](const rs::WriteBufferManager& self) {
+        return "WriteBufferManager(buffer_size=" + std::to_string(self.BufferSize()) +
+               ", memory_usage=" + std::to_string(self.MemoryUsage()) +
+               ", allow_stall=" + (self.Args().allow_stall ? "True" : "False") + ")";
+      });
+
+  // --- PinnedValue Bindings ---
+  py::class_<rs::PinnedValue, std::shared_ptr<rs::PinnedValue>>(m, "PinnedValue", py::buffer_protocol())
+    .def_buffer([](rs::PinnedValue& self) {
+        auto sv = self.View();
+        return py::buffer_info(const_cast<char*>(sv.data()), 1, "B", static_cast<py::ssize_t>(sv.size()),
+                               /*readonly=*/true);
+      })
+    .def("__len__", [](const rs::PinnedValue& self) { return self.View().size(); })
+    .def("__bytes__", [](const rs::PinnedValue& self) {
+        auto sv = self.View();
+        return py::bytes(sv.data(), sv.size());
+      });
 
   // --- WriteBatch Bindings ---
   py::class_<rs::WriteBatch, std::shared_ptr<rs::WriteBatch>>(m, "WriteBatch")
@@ -34,12 +507,23 @@ PYBIND11_MODULE(rocks_shim, m) {
         }
         return false;
     })
-    .def("put",    [](rs::WriteBatch& self, py::bytes k, py::bytes v){ self.Put(std::string(k), std::string(v)); })
-    .def("delete", [](rs::WriteBatch& self, py::bytes k){ self.Delete(std::string(k)); })
-    .def("merge",  [](rs::WriteBatch& self, py::bytes k, py::bytes v){ self.Merge(std::string(k), std::string(v)); })
+    .def("acommit", [](std::shared_ptr<rs::WriteBatch> self) {
+        return run_async([self]() -> Deliver {
+          self->Commit();
+          return [] { return py::object(py::none()); };
+        });
+      },
+      "Awaitable commit; leave the batch alone until it resolves")
+    .def("put",    [](rs::WriteBatch& self, py::bytes k, py::bytes v){ self.Put(view_of(k), view_of(v)); })
+    .def("delete", [](rs::WriteBatch& self, py::bytes k){ self.Delete(view_of(k)); })
+    .def("merge",  [](rs::WriteBatch& self, py::bytes k, py::bytes v){ self.Merge(view_of(k), view_of(v)); })
+    .def("delete_range", [](rs::WriteBatch& self, py::bytes begin, py::bytes end){ self.DeleteRange(view_of(begin), view_of(end)); },
+         py::arg("begin"), py::arg("end"), "Delete all keys in [begin, end)")
     .def("put_batch", [](rs::WriteBatch& self, py::list items) {
-        // Convert Python list of tuples to C++ vector
-        std::vector<std::pair<std::string, std::string>> batch;
+        // Borrow each key/value; `hold` keeps them referenced until the GIL is back
+        std::vector<py::bytes> hold;
+        std::vector<std::pair<std::string_view, std::string_view>> batch;
+        hold.reserve(2 * items.size());
         batch.reserve(items.size());
 
         for (auto item : items) {
@@ -47,9 +531,9 @@ PYBIND11_MODULE(rocks_shim, m) {
             if (tuple.size() != 2) {
                 throw std::invalid_argument("put_batch requires list of (key, value) tuples");
             }
-            auto k = tuple[0].cast<py::bytes>();
-            auto v = tuple[1].cast<py::bytes>();
-            batch.emplace_back(std::string(k), std::string(v));
+            auto& k = hold.emplace_back(tuple[0].cast<py::bytes>());
+            auto& v = hold.emplace_back(tuple[1].cast<py::bytes>());
+            batch.emplace_back(view_of(k), view_of(v));
         }
 
         // Release GIL for bulk operation
@@ -57,8 +541,10 @@ PYBIND11_MODULE(rocks_shim, m) {
         self.PutBatch(batch);
     }, py::arg("items"), "Put multiple key-value pairs in a single call")
     .def("merge_batch", [](rs::WriteBatch& self, py::list items) {
-        // Convert Python list of tuples to C++ vector
-        std::vector<std::pair<std::string, std::string>> batch;
+        // Borrow each key/value; `hold` keeps them referenced until the GIL is back
+        std::vector<py::bytes> hold;
+        std::vector<std::pair<std::string_view, std::string_view>> batch;
+        hold.reserve(2 * items.size());
         batch.reserve(items.size());
 
         for (auto item : items) {
@@ -66,60 +552,422 @@ PYBIND11_MODULE(rocks_shim, m) {
             if (tuple.size() != 2) {
                 throw std::invalid_argument("merge_batch requires list of (key, value) tuples");
             }
-            auto k = tuple[0].cast<py::bytes>();
-            auto v = tuple[1].cast<py::bytes>();
-            batch.emplace_back(std::string(k), std::string(v));
+            auto& k = hold.emplace_back(tuple[0].cast<py::bytes>());
+            auto& v = hold.emplace_back(tuple[1].cast<py::bytes>());
+            batch.emplace_back(view_of(k), view_of(v));
         }
 
         // Release GIL for bulk operation
         py::gil_scoped_release release;
         self.MergeBatch(batch);
-    }, py::arg("items"), "Merge multiple key-value pairs in a single call");
+    }, py::arg("items"), "Merge multiple key-value pairs in a single call")
+    .def("put_buffers", [](rs::WriteBatch& self, py::buffer keys, py::buffer key_offsets,
+                           py::buffer values, py::buffer value_offsets) {
+        PackedArg k(keys, key_offsets, "keys");
+        PackedArg v(values, value_offsets, "values");
+
+        // Release GIL for validation and the whole append
+        py::gil_scoped_release release;
+        k.Validate();
+        v.Validate();
+        self.PutBuffers(k.view, v.view);
+      },
+      py::arg("keys"), py::arg("key_offsets"), py::arg("values"), py::arg("value_offsets"),
+      "Put n pairs from flat buffers; each offsets buffer holds n + 1 integers")
+    .def("merge_buffers", [](rs::WriteBatch& self, py::buffer keys, py::buffer key_offsets,
+                             py::buffer values, py::buffer value_offsets) {
+        PackedArg k(keys, key_offsets, "keys");
+        PackedArg v(values, value_offsets, "values");
+
+        // Release GIL for validation and the whole append
+        py::gil_scoped_release release;
+        k.Validate();
+        v.Validate();
+        self.MergeBuffers(k.view, v.view);
+      },
+      py::arg("keys"), py::arg("key_offsets"), py::arg("values"), py::arg("value_offsets"),
+      "Merge n pairs from flat buffers; each offsets buffer holds n + 1 integers");
+
+  // --- IndexedWriteBatch Bindings ---
+  py::class_<rs::IndexedWriteBatch, rs::WriteBatch, std::shared_ptr<rs::IndexedWriteBatch>>(m, "IndexedWriteBatch")
+    .def("get_from_batch", [](rs::IndexedWriteBatch& self, py::bytes k) -> py::object {
+        std::string out;
+        if (self.GetFromBatch(view_of(k), &out)) {
+            return py::bytes(out);
+        }
+        return py::none();
+      }, py::arg("key"), "Value pending in this batch, or None")
+    .def("get_from_batch_and_db", [](rs::IndexedWriteBatch& self, py::bytes k, py::object options) -> py::object {
+        rs::ReadArgs ra = read_args_of(options);
+        std::string out;
+        auto ks = view_of(k);
+        bool found;
+        {
+          py::gil_scoped_release release;
+          found = self.GetFromBatchAndDB(ks, &out, ra);
+        }
+        if (found) {
+            return py::bytes(out);
+        }
+        return py::none();
+      }, py::arg("key"), py::kw_only(), py::arg("options") = py::none(),
+      "Value as it will read after commit (batch layered over the DB), or None")
+    .def("iterator", [](rs::IndexedWriteBatch& self, py::object options, std::optional<bool> fill_cache,
+                        std::optional<size_t> readahead_size, std::optional<bool> async_io) {
+        rs::ReadArgs ra = read_args_of(options);
+        apply_overrides(ra, fill_cache, readahead_size, async_io);
+        return self.NewIterator(ra);
+      },
+      py::kw_only(), py::arg("options") = py::none(), py::arg("fill_cache") = py::none(),
+      py::arg("readahead_size") = py::none(), py::arg("async_io") = py::none(),
+      py::keep_alive<0,1>(),
+      "Iterator over the DB with this batch's pending writes applied");
+
+  // --- AutoWriteBatch Bindings ---
+  // Single appends keep the GIL (releasing it per put costs more than the put) and drop it
+  // only when the append is going to wait for the background committer.
+  py::class_<rs::AutoWriteBatch, rs::WriteBatch, std::shared_ptr<rs::AutoWriteBatch>>(m, "AutoWriteBatch",
+      "Write batch that commits in the background. Appends from several threads are safe.\n"
+      "Dropping it commits what is left, but an error from that last write is lost: call commit() first")
+    .def("put", [](rs::AutoWriteBatch& self, py::bytes k, py::bytes v){
+        auto ks = view_of(k), vs = view_of(v);
+        auto_append(self, ks.size() + vs.size(), [&] { self.Put(ks, vs); });
+      }, py::arg("key"), py::arg("value"))
+    .def("delete", [](rs::AutoWriteBatch& self, py::bytes k){
+        auto ks = view_of(k);
+        auto_append(self, ks.size(), [&] { self.Delete(ks); });
+      }, py::arg("key"))
+    .def("merge", [](rs::AutoWriteBatch& self, py::bytes k, py::bytes v){
+        auto ks = view_of(k), vs = view_of(v);
+        auto_append(self, ks.size() + vs.size(), [&] { self.Merge(ks, vs); });
+      }, py::arg("key"), py::arg("value"))
+    .def("delete_range", [](rs::AutoWriteBatch& self, py::bytes begin, py::bytes end){
+        auto b = view_of(begin), e = view_of(end);
+        auto_append(self, b.size() + e.size(), [&] { self.DeleteRange(b, e); });
+      }, py::arg("begin"), py::arg("end"))
+    .def("commit", &rs::AutoWriteBatch::Commit, py::call_guard<py::gil_scoped_release>(),
+         "Hand off pending writes and wait until everything appended so far is committed")
+    .def("flush", &rs::AutoWriteBatch::Flush, py::call_guard<py::gil_scoped_release>(),
+         "Hand off pending writes to the background committer without waiting")
+    .def_property_readonly("committed_ops", &rs::AutoWriteBatch::CommittedOps)
+    .def_property_readonly("committed_bytes", &rs::AutoWriteBatch::CommittedBytes);
+
+  // --- WriterPool Bindings ---
+  py::class_<rs::WriterPool, std::shared_ptr<rs::WriterPool>>(m, "WriterPool")
+    .def("__enter__", [](std::shared_ptr<rs::WriterPool> self){ return self; })
+    .def("__exit__",  [](rs::WriterPool& self, py::object, py::object, py::object){
+        py::gil_scoped_release release;
+        self.Close();
+        return false;
+    })
+    .def("submit", &rs::WriterPool::Submit, py::arg("batch"), py::call_guard<py::gil_scoped_release>(),
+         "Queue a WriteBatch's pending writes; the batch is left empty and can be reused")
+    .def("put_buffers", [](rs::WriterPool& self, py::buffer keys, py::buffer key_offsets,
+                           py::buffer values, py::buffer value_offsets) {
+        PackedArg k(keys, key_offsets, "keys");
+        PackedArg v(values, value_offsets, "values");
+
+        py::gil_scoped_release release;
+        k.Validate();
+        v.Validate();
+        self.SubmitBuffers(k.view, v.view, /*merge=*/false);
+      },
+      py::arg("keys"), py::arg("key_offsets"), py::arg("values"), py::arg("value_offsets"),
+      "Queue n puts from flat buffers as one batch")
+    .def("merge_buffers", [](rs::WriterPool& self, py::buffer keys, py::buffer key_offsets,
+                             py::buffer values, py::buffer value_offsets) {
+        PackedArg k(keys, key_offsets, "keys");
+        PackedArg v(values, value_offsets, "values");
+
+        py::gil_scoped_release release;
+        k.Validate();
+        v.Validate();
+        self.SubmitBuffers(k.view, v.view, /*merge=*/true);
+      },
+      py::arg("keys"), py::arg("key_offsets"), py::arg("values"), py::arg("value_offsets"),
+      "Queue n merges from flat buffers as one batch")
+    .def("wait", &rs::WriterPool::Wait, py::call_guard<py::gil_scoped_release>(),
+         "Block until all submitted batches are written; raises the first write error")
+    .def("stats", [](const rs::WriterPool& self) {
+        auto st = self.Stats();
+        py::dict d;
+        d["batches"] = st.batches;
+        d["ops"] = st.ops;
+        d["bytes"] = st.bytes;
+        d["errors"] = st.errors;
+        d["pending"] = st.pending;
+        d["elapsed_sec"] = st.elapsed_sec;
+        d["ops_per_sec"] = st.elapsed_sec > 0 ? st.ops / st.elapsed_sec : 0.0;
+        d["bytes_per_sec"] = st.elapsed_sec > 0 ? st.bytes / st.elapsed_sec : 0.0;
+        return d;
+      })
+    .def("close", &rs::WriterPool::Close, py::call_guard<py::gil_scoped_release>());
 
   // --- DB Bindings ---
   py::class_<rs::DB, std::shared_ptr<rs::DB>>(m, "DB")
     .def_static("open",
-      [](const std::string& path, bool read_only, bool create_if_missing, const std::string& profile){
+      [](const std::string& path, bool read_only, bool create_if_missing, const std::string& profile,
+         py::object overlay, unsigned cpus, uint64_t memory_bytes, std::shared_ptr<rs::BlockCache> block_cache,
+         const std::string& cache_type, uint64_t secondary_cache,
+         std::shared_ptr<rs::WriteBufferManager> write_buffer_manager, uint64_t io_rate_limit,
+         bool io_rate_auto_tune, bool statistics){
         rs::OpenArgs a;
         a.path = path;
         a.read_only = read_only;
         a.create_if_missing = create_if_missing;
         a.profile = profile.empty() ? (read_only ? "read" : "write") : profile;
+        a.options_overlay = overlay_text(overlay);
+        a.cpus = cpus;
+        a.memory_bytes = memory_bytes;
+        a.block_cache = std::move(block_cache);
+        a.cache_type = cache_type;
+        a.secondary_cache_bytes = secondary_cache;
+        a.write_buffer_manager = std::move(write_buffer_manager);
+        a.io_rate_limit = io_rate_limit;
+        a.io_rate_auto_tune = io_rate_auto_tune;
+        a.statistics = statistics;
 
         py::gil_scoped_release release;
         return rs::DB::Open(a);
       },
-      py::arg("path"), py::kw_only(), py::arg("read_only")=false, py::arg("create_if_missing")=false, py::arg("profile") = "")
+      py::arg("path"), py::kw_only(), py::arg("read_only")=false, py::arg("create_if_missing")=false, py::arg("profile") = "",
+      py::arg("overlay") = py::none(), py::arg("cpus") = 0, py::arg("memory_bytes") = 0,
+      py::arg("block_cache") = py::none(), py::arg("cache_type") = "", py::arg("secondary_cache") = 0,
+      py::arg("write_buffer_manager") = py::none(), py::arg("io_rate_limit") = 0, py::arg("io_rate_auto_tune") = false,
+      py::arg("statistics") = false,
+      "profile: read | write | ingest-universal [:packed24] | file:<OPTIONS file or DB dir>. overlay: RocksDB option text,\n"
+      "an .ini/.json file, or a dict, applied on top of the profile. cpus / memory_bytes: size the\n"
+      "profile for this much hardware instead of what hardware_info() detects (0 = detect).\n"
+      "block_cache: a BlockCache shared with other DBs instead of the profile's own. cache_type: the\n"
+      "profile's own cache, lru (default) or hyper_clock. secondary_cache: bytes of LZ4-compressed\n"
+      "tier below the profile's own cache. write_buffer_manager: a memtable budget shared with other DBs.\n"
+      "io_rate_limit: bytes/s for flush and compaction I/O (0 = unlimited), auto-tuned below that ceiling\n"
+      "with io_rate_auto_tune. statistics: count block cache hits/misses for cache_stats()")
     .def("__enter__", [](std::shared_ptr<rs::DB> self){ return self; })
     .def("__exit__",  [](rs::DB& self, py::object, py::object, py::object){ self.Close(); return false; })
     .def("close", &rs::DB::Close, py::call_guard<py::gil_scoped_release>())
     .def("__getitem__", [](rs::DB& self, py::bytes k) {
-        py::gil_scoped_release release;
-        std::string out;
-        if (self.Get(std::string(k), &out)) {
-            return py::bytes(out);
+        auto ks = view_of(k);
+        std::shared_ptr<rs::PinnedValue> v;
+        {
+          py::gil_scoped_release release;
+          v = self.GetPinned(ks);
+        }
+        if (v) {
+            auto sv = v->View();
+            return py::bytes(sv.data(), sv.size());  // the only copy: pinned block -> bytes
         }
         throw py::key_error("Key not found");
     })
-    .def("get", [](rs::DB& self, py::bytes k) -> py::object {
-        py::gil_scoped_release release;
-        std::string out;
-        if (self.Get(std::string(k), &out)) {
-            return py::bytes(out);
+    .def("get", [](rs::DB& self, py::bytes k, py::object options) -> py::object {
+        rs::ReadArgs ra = read_args_of(options);
+        auto ks = view_of(k);
+        std::shared_ptr<rs::PinnedValue> v;
+        {
+          py::gil_scoped_release release;
+          v = self.GetPinned(ks, ra);
+        }
+        if (v) {
+            auto sv = v->View();
+            return py::bytes(sv.data(), sv.size());
         }
         return py::none();
-      })
-    .def("put",    [](rs::DB& self, py::bytes k, py::bytes v){ py::gil_scoped_release r; self.Put(std::string(k), std::string(v)); })
-    .def("delete", [](rs::DB& self, py::bytes k){ py::gil_scoped_release r; self.Delete(std::string(k)); })
-    .def("merge",  [](rs::DB& self, py::bytes k, py::bytes v){ py::gil_scoped_release r; self.Merge(std::string(k), std::string(v)); })
-    .def("iterator", &rs::DB::NewIterator, py::keep_alive<0,1>())
+      },
+      py::arg("key"), py::kw_only(), py::arg("options") = py::none(),
+      "Value or None. options: a ReadOptions or preset name (cache_only raises IncompleteError on a miss)")
+    .def("get_pinned", [](rs::DB& self, py::bytes k, py::object options) -> py::object {
+        rs::ReadArgs ra = read_args_of(options);
+        auto ks = view_of(k);
+        std::shared_ptr<rs::PinnedValue> v;
+        {
+          py::gil_scoped_release release;
+          v = self.GetPinned(ks, ra);
+        }
+        if (v) return py::cast(std::move(v));
+        return py::none();
+      },
+      py::arg("key"), py::kw_only(), py::arg("options") = py::none(), py::keep_alive<0,1>(),
+      "Zero-copy lookup: a PinnedValue supporting the buffer protocol, or None. Release it before close()")
+    .def("get_into", [](rs::DB& self, py::bytes k, py::buffer buf, py::object options) -> py::object {
+        rs::ReadArgs ra = read_args_of(options);
+        py::buffer_info info = buf.request(/*writable=*/true);
+        if (!is_c_contiguous(info)) throw std::invalid_argument("get_into buffer must be C-contiguous");
+        const size_t cap = static_cast<size_t>(info.size * info.itemsize);
+        auto ks = view_of(k);
+        std::optional<size_t> n;
+        {
+          py::gil_scoped_release release;
+          n = self.GetInto(ks, static_cast<char*>(info.ptr), cap, ra);
+        }
+        if (!n) return py::none();
+        if (*n > cap) {
+          throw py::value_error("get_into buffer holds " + std::to_string(cap) + " bytes; value needs " +
+                                std::to_string(*n));
+        }
+        return py::int_(*n);
+      },
+      py::arg("key"), py::arg("buffer"), py::kw_only(), py::arg("options") = py::none(),
+      "Copy the value into a writable buffer; returns its length, or None if the key is absent")
+    .def("multi_get", [](rs::DB& self, py::object keys, py::object offsets, py::object options,
+                         std::optional<bool> fill_cache, std::optional<bool> async_io) -> py::object {
+        rs::ReadArgs ra = read_args_of(options, multi_get_defaults());
+        apply_overrides(ra, fill_cache, std::nullopt, async_io);
+        rs::MultiGetResult res;
+
+        if (offsets.is_none()) {
+          // List of keys in, list of bytes/None out
+          std::vector<py::bytes> hold;
+          auto ks = borrow_keys(keys, hold);
+          {
+            py::gil_scoped_release release;
+            res = self.MultiGet(ks, ra);
+          }
+          return values_as_list(res);
+        }
+
+        // Keys blob + offsets in, (values blob, offsets, found) out
+        PackedArg k(keys.cast<py::buffer>(), offsets.cast<py::buffer>(), "keys");
+        {
+          py::gil_scoped_release release;
+          k.Validate();
+          res = self.MultiGetBuffers(k.view, ra);
+        }
+        return values_as_packed(res);
+      },
+      py::arg("keys"), py::arg("offsets") = py::none(), py::kw_only(), py::arg("options") = py::none(),
+      py::arg("fill_cache") = py::none(), py::arg("async_io") = py::none(),
+      "Look up many keys at once. With a list: returns a list of bytes/None. With a keys buffer and\n"
+      "offsets: returns (values, offsets, found), offsets and found being uint64/bool memoryviews")
+    .def("may_exist", [](rs::DB& self, py::object keys, py::object offsets, bool with_values,
+                         py::object options) -> py::object {
+        rs::ReadArgs ra = read_args_of(options);
+        std::vector<uint8_t> mask;
+        rs::MultiGetResult vals;
+        rs::MultiGetResult* vp = with_values ? &vals : nullptr;
+
+        std::vector<py::bytes> hold;
+        const bool as_list = offsets.is_none();
+        if (as_list) {
+          auto ks = borrow_keys(keys, hold);
+          py::gil_scoped_release release;
+          mask = self.MayExist(ks, vp, ra);
+        } else {
+          PackedArg k(keys.cast<py::buffer>(), offsets.cast<py::buffer>(), "keys");
+          py::gil_scoped_release release;
+          k.Validate();
+          mask = self.MayExistBuffers(k.view, vp, ra);
+        }
+
+        if (!with_values) return mask_view(mask);
+        if (as_list) return py::make_tuple(mask_view(mask), values_as_list(vals));
+        py::tuple packed = values_as_packed(vals);
+        return py::make_tuple(mask_view(mask), packed[0], packed[1], packed[2]);
+      },
+      py::arg("keys"), py::arg("offsets") = py::none(), py::kw_only(), py::arg("with_values") = false,
+      py::arg("options") = py::none(),
+      "Bloom/memory-only existence check; returns a bool memoryview (False = definitely absent).\n"
+      "with_values also returns the values already in memory, in the same form as multi_get.\n"
+      "options: a ReadOptions or preset name; the check never reads from disk whatever they say")
+    .def("aget", [](std::shared_ptr<rs::DB> self, py::bytes k, py::object options) {
+        rs::ReadArgs ra = read_args_of(options);
+        return run_async([self, key = std::string(view_of(k)), ra]() -> Deliver {
+          auto v = self->GetPinned(key, ra);
+          if (!v) return [] { return py::object(py::none()); };
+          return [v, self] {  // self: the pinned block must not outlive the DB
+            auto sv = v->View();
+            return py::object(py::bytes(sv.data(), sv.size()));
+          };
+        });
+      },
+      py::arg("key"), py::kw_only(), py::arg("options") = py::none(),
+      "Awaitable get(): resolves to bytes or None")
+    .def("amulti_get", [](std::shared_ptr<rs::DB> self, py::object keys, py::object offsets, py::object options,
+                          std::optional<bool> fill_cache, std::optional<bool> async_io) {
+        rs::ReadArgs ra = read_args_of(options, multi_get_defaults());
+        apply_overrides(ra, fill_cache, std::nullopt, async_io);
+        auto ks = std::make_shared<OwnedKeys>(copy_keys(keys, offsets));
+        return run_async([self, ks, ra]() -> Deliver {
+          auto res = std::make_shared<rs::MultiGetResult>(self->MultiGetBuffers(ks->view(), ra));
+          if (ks->as_list) return [res] { return py::object(values_as_list(*res)); };
+          return [res] { return py::object(values_as_packed(*res)); };
+        });
+      },
+      py::arg("keys"), py::arg("offsets") = py::none(), py::kw_only(), py::arg("options") = py::none(),
+      py::arg("fill_cache") = py::none(), py::arg("async_io") = py::none(),
+      "Awaitable multi_get(); resolves to the same forms")
+    .def("acompact_range", [](std::shared_ptr<rs::DB> self, py::object start, py::object end, bool exclusive) {
+        std::optional<std::string> start_key, end_key;
+        if (!start.is_none()) start_key = std::string(py::bytes(start));
+        if (!end.is_none()) end_key = std::string(py::bytes(end));
+        return run_async([self, start_key, end_key, exclusive]() -> Deliver {
+          self->CompactRange(start_key, end_key, exclusive);
+          return [] { return py::object(py::none()); };
+        });
+      },
+      py::arg("start") = py::none(), py::arg("end") = py::none(), py::arg("exclusive") = true,
+      "Awaitable compact_range()")
+    .def("put",    [](rs::DB& self, py::bytes k, py::bytes v){ auto ks = view_of(k), vs = view_of(v); py::gil_scoped_release r; self.Put(ks, vs); })
+    .def("delete", [](rs::DB& self, py::bytes k){ auto ks = view_of(k); py::gil_scoped_release r; self.Delete(ks); })
+    .def("merge",  [](rs::DB& self, py::bytes k, py::bytes v){ auto ks = view_of(k), vs = view_of(v); py::gil_scoped_release r; self.Merge(ks, vs); })
+    .def("delete_range", [](rs::DB& self, py::bytes begin, py::bytes end, bool drop_files) {
+        auto b = view_of(begin), e = view_of(end);
+        py::gil_scoped_release r;
+        self.DeleteRange(b, e, drop_files);
+      },
+      py::arg("begin"), py::arg("end"), py::kw_only(), py::arg("drop_files") = false,
+      "Delete all keys in [begin, end). drop_files first unlinks SSTs fully inside the range; their\n"
+      "data disappears even under open snapshots and iterators, so only use it when no reader needs it")
+    .def("delete_prefix", [](rs::DB& self, py::bytes prefix, bool drop_files) {
+        auto p = view_of(prefix);
+        py::gil_scoped_release r;
+        self.DeletePrefix(p, drop_files);
+      },
+      py::arg("prefix"), py::kw_only(), py::arg("drop_files") = false,
+      "Delete every key starting with prefix; drop_files as for delete_range. For an empty or all-0xFF\n"
+      "prefix the range ends at the last key present at call time: a concurrent write past it survives")
+    .def("iterator", [](rs::DB& self, py::object options, std::optional<bool> fill_cache,
+                        std::optional<size_t> readahead_size, std::optional<bool> async_io, bool tailing) {
+        rs::ReadArgs ra = read_args_of(options);
+        apply_overrides(ra, fill_cache, readahead_size, async_io);
+        ra.tailing = tailing;
+        return self.NewIterator(ra);
+      },
+      py::kw_only(), py::arg("options") = py::none(), py::arg("fill_cache") = py::none(),
+      py::arg("readahead_size") = py::none(), py::arg("async_io") = py::none(), py::arg("tailing") = false,
+      py::keep_alive<0,1>())
+    .def("scan_iterator", [](rs::DB& self, py::object options, std::optional<bool> fill_cache,
+                             std::optional<size_t> readahead_size, std::optional<bool> async_io) {
+        rs::ReadArgs ra = read_args_of(options, rs::ReadArgs::Scan());
+        apply_overrides(ra, fill_cache, readahead_size, async_io);
+        return self.NewIterator(ra);
+      },
+      py::kw_only(), py::arg("options") = py::none(), py::arg("fill_cache") = py::none(),
+      py::arg("readahead_size") = py::none(), py::arg("async_io") = py::none(),
+      py::keep_alive<0,1>(),
+      "Iterator for bulk scans; by default it does not populate the block cache")
     .def("write_batch", &rs::DB::NewWriteBatch,
-         py::kw_only(), py::arg("disable_wal") = false, py::arg("sync") = false,
+         py::kw_only(), py::arg("disable_wal") = false, py::arg("sync") = false, py::arg("sort_keys") = false,
+         py::arg("ingest_threshold") = 0,
          py::keep_alive<0,1>())
+    .def("indexed_write_batch", &rs::DB::NewIndexedWriteBatch,
+         py::kw_only(), py::arg("disable_wal") = false, py::arg("sync") = false,
+         py::keep_alive<0,1>(),
+         "Write batch whose pending writes can be read back before commit")
+    .def("auto_write_batch", &rs::DB::NewAutoWriteBatch,
+         py::kw_only(), py::arg("max_bytes") = size_t(64) << 20, py::arg("max_ops") = 0,
+         py::arg("disable_wal") = false, py::arg("sync") = false,
+         py::keep_alive<0,1>(),
+         "Write batch that commits in the background whenever max_bytes or max_ops is reached")
+    .def("writer_pool", &rs::DB::NewWriterPool,
+         py::kw_only(), py::arg("threads") = 0, py::arg("max_pending") = 0,
+         py::arg("disable_wal") = false, py::arg("sync") = false,
+         py::keep_alive<0,1>(),
+         "Pool of C++ threads committing submitted batches concurrently")
     .def("finalize_bulk", &rs::DB::FinalizeBulk, py::call_guard<py::gil_scoped_release>())
+    .def("finalize_for_read", &rs::DB::FinalizeForRead, py::call_guard<py::gil_scoped_release>(),
+         "Flush, switch to the read profile's tables and compact everything once with them")
     .def("compact_all", &rs::DB::CompactAll, py::call_guard<py::gil_scoped_release>())
     .def("compact_range", [](rs::DB& self, py::object start, py::object end, bool exclusive) {
-        py::gil_scoped_release release;
         std::optional<std::string> start_key;
         std::optional<std::string> end_key;
 
@@ -130,28 +978,85 @@ PYBIND11_MODULE(rocks_shim, m) {
           end_key = std::string(py::bytes(end));
         }
 
+        py::gil_scoped_release release;
         self.CompactRange(start_key, end_key, exclusive);
       },
       py::arg("start") = py::none(), py::arg("end") = py::none(), py::arg("exclusive") = true,
       "Compact a specific key range")
     .def("get_property", &rs::DB::GetProperty, py::arg("name"))
+    .def("set_io_rate_limit", &rs::DB::SetIoRateLimit, py::arg("bytes_per_sec"),
+         "Throttle flush and compaction I/O to bytes_per_sec (0 = unlimited). Applies to running compactions")
+    .def_property_readonly("io_rate_limit", &rs::DB::IoRateLimit,
+                           "Current flush/compaction I/O rate in bytes/s, 0 if unlimited")
+    .def("cache_stats", [](rs::DB& self) {
+        rs::BlockCacheStats st;
+        {
+          py::gil_scoped_release release;
+          st = self.CacheStats();
+        }
+        py::dict d;
+        d["shared"] = st.shared;
+        d["capacity"] = st.capacity;
+        d["usage"] = st.usage;
+        d["pinned_usage"] = st.pinned_usage;
+        d["statistics"] = st.statistics;
+        d["hits"] = st.hits;
+        d["misses"] = st.misses;
+        d["hit_rate"] = st.hits + st.misses > 0 ? double(st.hits) / double(st.hits + st.misses) : 0.0;
+        d["bytes_inserted"] = st.bytes_inserted;
+        d["bytes_read"] = st.bytes_read;
+        d["secondary_hits"] = st.secondary_hits;
+        return d;
+      },
+      "Block cache usage (whole cache, shared with other DBs if 'shared') and this DB's hits/misses\n"
+      "(zero unless opened with statistics=True); secondary_hits counts the hits served from the compressed tier")
     .def("ingest", &rs::DB::IngestExternalFiles,
          py::arg("paths"), py::kw_only(), py::arg("move")=true, py::arg("write_global_seqno")=false);
 
   // Module-level open function for api.py compatibility
   m.def("open",
-    [](const std::string& path, const std::string& mode, bool create_if_missing, const std::string& profile){
+    [](const std::string& path, const std::string& mode, bool create_if_missing, const std::string& profile,
+       py::object overlay, unsigned cpus, uint64_t memory_bytes, std::shared_ptr<rs::BlockCache> block_cache,
+       const std::string& cache_type, uint64_t secondary_cache,
+       std::shared_ptr<rs::WriteBufferManager> write_buffer_manager, uint64_t io_rate_limit,
+       bool io_rate_auto_tune, bool statistics){
       rs::OpenArgs a;
       a.path = path;
       a.read_only = (mode == "r");
       a.create_if_missing = create_if_missing;
       a.profile = profile.empty() ? (a.read_only ? "read" : "write") : profile;
+      a.options_overlay = overlay_text(overlay);
+      a.cpus = cpus;
+      a.memory_bytes = memory_bytes;
+      a.block_cache = std::move(block_cache);
+      a.cache_type = cache_type;
+      a.secondary_cache_bytes = secondary_cache;
+      a.write_buffer_manager = std::move(write_buffer_manager);
+      a.io_rate_limit = io_rate_limit;
+      a.io_rate_auto_tune = io_rate_auto_tune;
+      a.statistics = statistics;
 
       py::gil_scoped_release release;
       return rs::DB::Open(a);
     },
     py::arg("path"), py::kw_only(), py::arg("mode")="rw",
-    py::arg("create_if_missing")=false, py::arg("profile") = "");
+    py::arg("create_if_missing")=false, py::arg("profile") = "", py::arg("overlay") = py::none(),
+    py::arg("cpus") = 0, py::arg("memory_bytes") = 0, py::arg("block_cache") = py::none(),
+    py::arg("cache_type") = "", py::arg("secondary_cache") = 0, py::arg("write_buffer_manager") = py::none(),
+    py::arg("io_rate_limit") = 0, py::arg("io_rate_auto_tune") = false, py::arg("statistics") = false);
+
+  m.def("hardware_info", []() {
+      const rs::HardwareInfo hw = rs::DetectHardware();
+      py::dict d;
+      d["cpus"] = hw.cpus;
+      d["memory_bytes"] = hw.memory_bytes;
+      d["numa_nodes"] = hw.numa_nodes;
+      d["numa_nodes_used"] = hw.numa_nodes_used;
+      d["cpu_limited"] = hw.cpu_limited;
+      d["memory_limited"] = hw.memory_limited;
+      return d;
+    },
+    "CPUs and memory the built-in profiles size themselves for (affinity, NUMA, cgroup limits)");
 
   // --- SstFileWriter Bindings ---
   py::class_<rs::SstFileWriter, std::shared_ptr<rs::SstFileWriter>>(m, "SstFileWriter")
@@ -170,8 +1075,9 @@ PYBIND11_MODULE(rocks_shim, m) {
         self.Open(file_path);
       }, py::arg("file_path"), "Open an SST file for writing")
     .def("put", [](rs::SstFileWriter& self, py::bytes key, py::bytes value) {
+        auto ks = view_of(key), vs = view_of(value);
         py::gil_scoped_release release;
-        self.Put(std::string(key), std::string(value));
+        self.Put(ks, vs);
       }, py::arg("key"), py::arg("value"), "Add a key-value pair (keys must be in sorted order)")
     .def("finish", [](rs::SstFileWriter& self) {
         py::gil_scoped_release release;
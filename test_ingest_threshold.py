@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Test script for write batches committed through SST ingestion (ingest_threshold)."""
+import glob
+import shutil
+import struct
+import tempfile
+
+import rocks_shim
+
+THRESHOLD = 1 << 20
+
+
+def rec(key, count, volume):
+    return struct.pack("<QQQ", key, count, volume)
+
+
+def sst_files(db_dir):
+    return sorted(glob.glob(f"{db_dir}/*.sst"))
+
+
+def leftovers(db_dir):
+    # Each ingesting commit stages its files in its own .rshim-ingest-* directory
+    return sorted(glob.glob(f"{db_dir}/.rshim-ingest*"))
+
+
+def dump(db):
+    it = db.iterator()
+    it.seek(b"")
+    out = {}
+    while it.valid():
+        out[it.key()] = it.value()
+        it.next()
+    return out
+
+
+def test_ingest_threshold():
+    db_dir = tempfile.mkdtemp()
+    plain_dir = tempfile.mkdtemp()
+
+    try:
+        db = rocks_shim.DB.open(db_dir, create_if_missing=True, profile="write:packed24")
+        expected = {}
+
+        print("1. A batch below the threshold goes through the memtable...")
+        with db.write_batch(disable_wal=True, ingest_threshold=THRESHOLD) as wb:
+            for i in range(100):
+                wb.put(b"small%04d" % i, b"s" * 100)
+                expected[b"small%04d" % i] = b"s" * 100
+        assert sst_files(db_dir) == [], sst_files(db_dir)
+        assert dump(db) == expected
+        print("   ✅ no SST files written, contents match")
+
+        print("\n2. A batch above the threshold is ingested as SST files...")
+        value = b"v" * 100
+        with db.write_batch(disable_wal=True, ingest_threshold=THRESHOLD) as wb:
+            for i in range(20000):
+                wb.put(b"big%06d" % i, value)
+                expected[b"big%06d" % i] = value
+            # Repeated keys fold to one record each, as in the memtable path
+            wb.put(b"big000007", b"overwritten")
+            expected[b"big000007"] = b"overwritten"
+            wb.delete(b"big000009")
+            del expected[b"big000009"]
+            wb.delete(b"small0001")
+            del expected[b"small0001"]
+            wb.put(b"counter", rec(1, 1, 1))
+            wb.merge(b"counter", rec(1, 2, 2))
+            wb.merge(b"counter", rec(2, 1, 1))
+            expected[b"counter"] = rec(1, 3, 3) + rec(2, 1, 1)
+            wb.merge(b"runs", rec(4, 1, 1))
+            wb.merge(b"runs", rec(3, 1, 1))
+            expected[b"runs"] = rec(3, 1, 1) + rec(4, 1, 1)
+        ingested = sst_files(db_dir)
+        assert ingested, "no SST files after an above-threshold commit"
+        assert dump(db) == expected
+        assert leftovers(db_dir) == [], leftovers(db_dir)
+        print(f"   ✅ {len(ingested)} SST file(s) ingested, contents match, no staging directory left")
+
+        print("\n3. Range deletes fall back to a normal write...")
+        with db.write_batch(disable_wal=True, ingest_threshold=THRESHOLD) as wb:
+            for i in range(20000):
+                wb.put(b"rng%06d" % i, value)
+                expected[b"rng%06d" % i] = value
+            wb.delete_range(b"big000100", b"big000200")
+            for i in range(100, 200):
+                del expected[b"big%06d" % i]
+        assert sst_files(db_dir) == ingested, "range delete batch was ingested"
+        assert dump(db) == expected
+        assert leftovers(db_dir) == [], leftovers(db_dir)
+        print("   ✅ written through the memtable, contents match")
+        db.close()
+
+        print("\n4. Merges the DB cannot fold fall back to a normal write...")
+        # No merge operator: put + merge on one key cannot become one record, so nothing is
+        # ingested and the batch takes the plain write path. That path is not atomic here:
+        # memtable insertion stops at the Merge after every Put before it has landed, and the
+        # DB keeps a background error. Its own DB keeps that away from the cases above.
+        plain = rocks_shim.DB.open(plain_dir, create_if_missing=True, profile="write")
+        try:
+            with plain.write_batch(disable_wal=True, ingest_threshold=THRESHOLD) as wb:
+                for i in range(20000):
+                    wb.put(b"k%06d" % i, value)
+                wb.merge(b"k000001", b"x")
+            raise AssertionError("merge without an operator was accepted")
+        except RuntimeError as e:
+            print(f"   ✅ raised: {e}")
+        assert sst_files(plain_dir) == [], "unfoldable batch was ingested"
+        assert leftovers(plain_dir) == [], leftovers(plain_dir)
+        assert dump(plain) == {b"k%06d" % i: value for i in range(20000)}
+        print("   ✅ not ingested, no staging directory; the puts ahead of the merge were applied")
+        plain.close()
+
+        print("\n✅ All tests passed!")
+
+    finally:
+        shutil.rmtree(db_dir, ignore_errors=True)
+        shutil.rmtree(plain_dir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    test_ingest_threshold()
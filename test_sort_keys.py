@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Test script for write batches committed with sort_keys=True."""
+import shutil
+import struct
+import tempfile
+
+import rocks_shim
+
+
+def rec(key, count, volume):
+    return struct.pack("<QQQ", key, count, volume)
+
+
+def write(db, ops, sort_keys):
+    with db.write_batch(sort_keys=sort_keys) as wb:
+        for op, *args in ops:
+            getattr(wb, op)(*args)
+
+
+def dump(db):
+    it = db.iterator()
+    it.seek(b"")
+    out = []
+    while it.valid():
+        out.append((it.key(), it.value()))
+        it.next()
+    return out
+
+
+def check_same(plain, sorted_, ops, what):
+    write(plain, ops, sort_keys=False)
+    write(sorted_, ops, sort_keys=True)
+    a, b = dump(plain), dump(sorted_)
+    if a != b:
+        raise AssertionError(f"{what}: sort_keys diverged\n  plain:  {a}\n  sorted: {b}")
+    print(f"   ✅ {what}: {len(a)} keys identical")
+
+
+def test_sort_keys():
+    plain_dir = tempfile.mkdtemp()
+    sorted_dir = tempfile.mkdtemp()
+
+    try:
+        plain = rocks_shim.DB.open(plain_dir, create_if_missing=True, profile="write:packed24")
+        sorted_ = rocks_shim.DB.open(sorted_dir, create_if_missing=True, profile="write:packed24")
+
+        print("1. Last put/delete on a key wins...")
+        check_same(plain, sorted_, [
+            ("put", b"c", b"c1"), ("put", b"a", b"a1"), ("put", b"c", b"c2"),
+            ("delete", b"a"), ("put", b"b", b"b1"), ("delete", b"b"), ("put", b"b", b"b2"),
+            ("put", b"d", b"d1"), ("delete", b"d"),
+        ], "put/delete")
+
+        print("\n2. Merges over a put or delete in the batch (FullMergeV2)...")
+        check_same(plain, sorted_, [
+            ("merge", b"m1", rec(3, 1, 10)), ("put", b"m1", rec(1, 1, 1)),
+            ("merge", b"m1", rec(2, 5, 50)), ("merge", b"m1", rec(1, 2, 20)),
+            ("delete", b"m2"), ("merge", b"m2", rec(7, 1, 1)), ("merge", b"m2", rec(7, 1, 1)),
+        ], "merge over base")
+
+        print("\n3. Merge-only runs folded against values already in the DB (PartialMergeMulti)...")
+        check_same(plain, sorted_, [("put", b"p", rec(1, 1, 1) + rec(5, 1, 1))], "seed base")
+        check_same(plain, sorted_, [
+            ("merge", b"p", rec(5, 2, 2)), ("merge", b"q", rec(9, 1, 1)),
+            ("merge", b"p", rec(3, 1, 1)), ("merge", b"q", rec(8, 1, 1)), ("merge", b"p", rec(1, 4, 4)),
+        ], "merge-only runs")
+
+        print("\n4. Range deletes order the records around them...")
+        check_same(plain, sorted_, [
+            ("put", b"r1", b"before"), ("put", b"r5", b"outside"), ("merge", b"r2", rec(1, 1, 1)),
+            ("delete_range", b"r0", b"r3"),
+            ("put", b"r1", b"after"), ("merge", b"r2", rec(2, 1, 1)),
+            ("delete_range", b"r1", b"r2"),
+            ("put", b"r0", b"last"),
+        ], "range-delete barriers")
+
+        plain.close()
+        sorted_.close()
+
+        print("\n5. Keys the merge operator cannot fold are written as they are...")
+        # No merge operator: several merges on one key cannot be folded, so the sorted batch
+        # carries them unchanged. RocksDB does not pre-validate a batch: memtable insertion
+        # stops at the first Merge, after the Put before it has landed, and the DB is left
+        # with a background error. Each path gets a fresh DB so the error stays contained.
+        ops = [("put", b"z1", b"v"), ("merge", b"z2", b"x"), ("merge", b"z2", b"y")]
+        states = []
+        for sort_keys in (False, True):
+            with tempfile.TemporaryDirectory() as d:
+                db = rocks_shim.DB.open(d, create_if_missing=True, profile="write")
+                try:
+                    write(db, ops, sort_keys)
+                    raise AssertionError(f"sort_keys={sort_keys}: merge without an operator was accepted")
+                except RuntimeError as e:
+                    print(f"   ✅ sort_keys={sort_keys} raised: {e}")
+                states.append(dump(db))
+                try:
+                    db.put(b"later", b"x")
+                    raise AssertionError(f"sort_keys={sort_keys}: write accepted after the failed batch")
+                except RuntimeError:
+                    pass
+                db.close()
+        assert states[0] == states[1] == [(b"z1", b"v")], states
+        print("   ✅ both paths applied the put before the merge, then stopped taking writes")
+
+        print("\n✅ All tests passed!")
+
+    finally:
+        shutil.rmtree(plain_dir, ignore_errors=True)
+        shutil.rmtree(sorted_dir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    test_sort_keys()